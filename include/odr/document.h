@@ -1,6 +1,7 @@
 #ifndef ODR_DOCUMENT_H
 #define ODR_DOCUMENT_H
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <string>
@@ -19,6 +20,11 @@ public:
   static std::string version() noexcept;
   static std::string commit() noexcept;
 
+  // bytes of intermediate buffers, like decrypted packages, which one document
+  // and all documents together keep in memory; the rest goes to temporary
+  // files. applies to documents opened afterwards
+  static void memory_budget(std::size_t document, std::size_t process) noexcept;
+
   static FileType type(const std::string &path);
   static FileMeta meta(const std::string &path);
 
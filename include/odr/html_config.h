@@ -2,6 +2,7 @@
 #define ODR_HTML_CONFIG_H
 
 #include <cstdint>
+#include <string>
 
 namespace odr {
 
@@ -17,10 +18,18 @@ struct HtmlConfig {
   std::uint32_t entry_offset{0};
   // translate only N sheets / pages; zero means translate all
   std::uint32_t entry_count{0};
-  // create output for each entry
+  // create output for each entry; the output path is taken as directory which
+  // gets `entry-N.html` per entry next to the shared `style.css` and
+  // `script.js`
   bool split_entries{false};
   // create editable output
   bool editable{false};
+  // translate entries on multiple threads; the output stays the same
+  bool parallel{false};
+  // write the images into a directory next to the output instead of inlining
+  // them; the path is relative to the directory of the output
+  bool external_resources{false};
+  std::string external_resource_path{"media"};
 
   // text document margin
   bool text_document_margin{false};
@@ -29,6 +38,11 @@ struct HtmlConfig {
   std::uint32_t table_limit_rows{10000};
   std::uint32_t table_limit_cols{500};
   bool table_limit_by_dimensions{true};
+  // merge runs of empty spreadsheet cells, rows and columns
+  bool table_compact{false};
+  // spreadsheet; write the cells as data which is rendered on demand by a
+  // script, ignored for editable output
+  bool table_virtualized{false};
   // spreadsheet gridlines
   HtmlTableGridlines table_gridlines{HtmlTableGridlines::SOFT};
 };
@@ -5,6 +5,7 @@
 #include <internal/common/archive.h>
 #include <internal/common/constants.h>
 #include <internal/common/path.h>
+#include <internal/common/spill_file.h>
 #include <internal/odf/odf_translator.h>
 #include <internal/oldms/oldms_translator.h>
 #include <internal/ooxml/ooxml_translator.h>
@@ -25,6 +26,8 @@ std::unique_ptr<internal::abstract::DocumentTranslator>
 open_impl(const std::string &path) {
   std::shared_ptr<common::DiscFile> disc_file =
       std::make_shared<common::DiscFile>(path);
+  // shared by all intermediate buffers of the document
+  const auto budget = std::make_shared<common::MemoryBudget>();
 
   try {
     common::ArchiveFile<zip::ReadonlyZipArchive> zip(disc_file);
@@ -32,14 +35,16 @@ open_impl(const std::string &path) {
     auto filesystem = zip.archive()->filesystem();
 
     try {
-      odf::OpenDocumentTranslator tmp(filesystem);
-      return std::make_unique<odf::OpenDocumentTranslator>(filesystem);
+      odf::OpenDocumentTranslator tmp(filesystem, budget);
+      return std::make_unique<odf::OpenDocumentTranslator>(filesystem,
+                                                           budget);
     } catch (...) {
       // TODO
     }
 
     try {
-      return std::make_unique<ooxml::OfficeOpenXmlTranslator>(filesystem);
+      return std::make_unique<ooxml::OfficeOpenXmlTranslator>(filesystem,
+                                                              budget);
     } catch (...) {
       // TODO
     }
@@ -48,9 +53,10 @@ open_impl(const std::string &path) {
   }
 
   try {
-    auto memory_file = std::make_shared<common::MemoryFile>(*disc_file);
+    // mapped into memory instead of copied where possible
+    auto spill_file = std::make_shared<common::SpillFile>(*disc_file, budget);
 
-    common::ArchiveFile<cfb::ReadonlyCfbArchive> cfb(memory_file);
+    common::ArchiveFile<cfb::ReadonlyCfbArchive> cfb(spill_file);
 
     auto filesystem = cfb.archive()->filesystem();
 
@@ -63,7 +69,8 @@ open_impl(const std::string &path) {
 
     // encrypted ooxml
     try {
-      return std::make_unique<ooxml::OfficeOpenXmlTranslator>(filesystem);
+      return std::make_unique<ooxml::OfficeOpenXmlTranslator>(filesystem,
+                                                              budget);
     } catch (...) {
       // TODO
     }
@@ -89,6 +96,12 @@ std::string Document::commit() noexcept {
   return internal::common::constants::commit();
 }
 
+void Document::memory_budget(const std::size_t document,
+                             const std::size_t process) noexcept {
+  common::MemoryBudget::document_limit(document);
+  common::MemoryBudget::process().limit(process);
+}
+
 FileType Document::type(const std::string &path) {
   const auto document = open_impl(path);
   return document->meta().type;
@@ -176,6 +176,10 @@ ReadonlyCfbArchive::ReadonlyCfbArchive(
     const std::shared_ptr<common::MemoryFile> &file)
     : m_cfb{std::make_shared<util::Archive>(file)} {}
 
+ReadonlyCfbArchive::ReadonlyCfbArchive(
+    const std::shared_ptr<common::SpillFile> &file)
+    : m_cfb{std::make_shared<util::Archive>(file)} {}
+
 ReadonlyCfbArchive::Iterator ReadonlyCfbArchive::begin() const {
   return Iterator(*this, *m_cfb->cfb().get_root_entry());
 }
@@ -7,6 +7,10 @@
 #include <optional>
 #include <vector>
 
+namespace odr::internal::common {
+class SpillFile;
+}
+
 namespace odr::internal::cfb::util {
 class Archive;
 }
@@ -16,6 +20,7 @@ namespace odr::internal::cfb {
 class ReadonlyCfbArchive final {
 public:
   explicit ReadonlyCfbArchive(const std::shared_ptr<common::MemoryFile> &file);
+  explicit ReadonlyCfbArchive(const std::shared_ptr<common::SpillFile> &file);
 
   class Iterator;
 
@@ -2,6 +2,7 @@
 #include <internal/cfb/cfb_impl.h>
 #include <internal/cfb/cfb_util.h>
 #include <internal/common/file.h>
+#include <internal/common/spill_file.h>
 #include <streambuf>
 
 namespace odr::internal::cfb::util {
@@ -73,6 +74,9 @@ int ReaderBuffer::underflow() {
 Archive::Archive(const std::shared_ptr<common::MemoryFile> &file)
     : m_cfb{file->content().data(), file->content().size()}, m_file{file} {}
 
+Archive::Archive(const std::shared_ptr<common::SpillFile> &file)
+    : m_cfb{file->content().data(), file->content().size()}, m_file{file} {}
+
 const impl::CompoundFileReader &Archive::cfb() const { return m_cfb; }
 
 std::shared_ptr<abstract::File> Archive::file() const { return m_file; }
@@ -92,4 +96,9 @@ FileInCfb::FileInCfb(std::shared_ptr<Archive> archive,
                                             m_entry);
 }
 
+void FileInCfb::read_at(const std::uint64_t offset, char *buffer,
+                        const std::size_t length) const {
+  m_archive->cfb().read_file(&m_entry, offset, buffer, length);
+}
+
 } // namespace odr::internal::cfb::util
@@ -9,6 +9,7 @@
 
 namespace odr::internal::common {
 class MemoryFile;
+class SpillFile;
 class DiscFile;
 } // namespace odr::internal::common
 
@@ -22,6 +23,7 @@ namespace odr::internal::cfb::util {
 class Archive final {
 public:
   explicit Archive(const std::shared_ptr<common::MemoryFile> &file);
+  explicit Archive(const std::shared_ptr<common::SpillFile> &file);
 
   [[nodiscard]] const impl::CompoundFileReader &cfb() const;
 
@@ -41,6 +43,9 @@ public:
   [[nodiscard]] std::size_t size() const final;
   [[nodiscard]] std::unique_ptr<std::istream> read() const final;
 
+  // random access; the range has to be inside of the file
+  void read_at(std::uint64_t offset, char *buffer, std::size_t length) const;
+
 private:
   std::shared_ptr<Archive> m_archive;
   const impl::CompoundFileEntry &m_entry;
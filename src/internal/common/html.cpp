@@ -1,9 +1,36 @@
 #include <internal/common/html.h>
 #include <internal/util/string_util.h>
 #include <odr/html_config.h>
+#include <vector>
 
 namespace odr::internal::common {
 
+namespace {
+void append_dependencies(
+    const std::unordered_map<std::string, std::list<std::string>>
+        &dependencies,
+    const std::string &name, std::vector<const std::string *> &visited,
+    std::string &result) {
+  const auto it = dependencies.find(name);
+  if (it == std::end(dependencies)) {
+    return;
+  }
+  for (auto i = it->second.rbegin(); i != it->second.rend(); ++i) {
+    bool known = false;
+    for (auto &&v : visited) {
+      known |= *v == *i;
+    }
+    if (known) {
+      continue;
+    }
+    visited.push_back(&*i);
+    result += " ";
+    result += *i;
+    append_dependencies(dependencies, *i, visited, result);
+  }
+}
+} // namespace
+
 const char *Html::doctype() noexcept {
   // clang-format off
   return R"V0G0N(<!DOCTYPE html>
@@ -104,6 +131,14 @@ const char *Html::default_script() noexcept {
   // clang-format on
 }
 
+const char *Html::virtual_table_script() noexcept {
+  // clang-format off
+  return
+    // from `resources/table.js`
+    R"V0G0N((function() {const overscan = 20;function init(root) {const data = JSON.parse(root.querySelector('script').textContent);const strings = data.strings;const table = root.querySelector('table');const top = root.querySelector('.odr-virtual-top');const bottom = root.querySelector('.odr-virtual-bottom');const cellAttributes = [];let colgroup = '';for (let i = 0; i < data.columns.length; i += 4) {const col = data.columns[i];const span = data.columns[i + 1];colgroup += '<col' + strings[data.columns[i + 2]] +(span > 1 ? ' span="' + span + '"' : '') + '>';for (let j = 0; j < span; ++j) {cellAttributes[col + j] = strings[data.columns[i + 3]];}}table.querySelector('colgroup').innerHTML = colgroup;const tbody = table.querySelector('tbody');const rowAttributes = {};for (let i = 0; i < data.rowAttributes.length; i += 2) {rowAttributes[data.rowAttributes[i]] = strings[data.rowAttributes[i + 1]];}const rows = {};const spanning = [];for (let i = 0; i < data.cells.length; i += 6) {const cell = data.cells.slice(i, i + 6);(rows[cell[0]] = rows[cell[0]] || []).push(cell);if (cell[3] > 1) {spanning.push(cell);}}let rowHeight = 20;let measured = false;let first = -1;let last = -1;function renderCell(cell, rowspan) {let result = '<td' + strings[cell[4]];if (cell[2] > 1) {result += ' colspan="' + cell[2] + '"';}if (rowspan > 1) {result += ' rowspan="' + rowspan + '"';}return result + '>' + strings[cell[5]] + '</td>';}function renderRow(row, cells, covered) {let result = '<tr' + (rowAttributes[row] || '') + '>';let col = 0;function gap(end) {while (col < end) {if (covered[col]) {++col;} else if (cellAttributes[col]) {result += '<td' + cellAttributes[col] + '></td>';++col;} else {let n = 1;while (col + n < end && !covered[col + n] &&!cellAttributes[col + n]) {++n;}result += n > 1 ? '<td colspan="' + n + '"></td>' : '<td></td>';col += n;}}}for (let i = 0; i < cells.length; ++i) {const cell = cells[i].cell;gap(cell[1]);result += renderCell(cell, cells[i].rowspan);col = Math.max(col, cell[1] + cell[2]);}gap(data.cols);return result + '</tr>';}function render() {const f = Math.max(0, Math.floor(root.scrollTop / rowHeight) - overscan);const l = Math.min(data.rows,Math.ceil((root.scrollTop + root.clientHeight) / rowHeight) +overscan);if (f === first && l === last) {return;}first = f;last = l;const pending = spanning.filter(function(cell) {return cell[0] < first && cell[0] + cell[3] > first;});let result = '';for (let row = first; row < last; ++row) {const covered = {};const cells = [];pending.forEach(function(cell) {if (row === first && cell[0] < first) {cells.push({cell: cell, rowspan: cell[0] + cell[3] - first});} else if (cell[0] < row && cell[0] + cell[3] > row) {for (let k = 0; k < cell[2]; ++k) {covered[cell[1] + k] = true;}}});(rows[row] || []).forEach(function(cell) {cells.push({cell: cell, rowspan: cell[3]});if (cell[3] > 1 && cell[0] >= first) {pending.push(cell);}});cells.sort(function(a, b) {return a.cell[1] - b.cell[1];});result += renderRow(row, cells, covered);}top.style.height = first * rowHeight + 'px';bottom.style.height = (data.rows - last) * rowHeight + 'px';tbody.innerHTML = result;if (!measured && last > first) {measured = true;rowHeight = Math.max(1, tbody.offsetHeight / (last - first));first = -1;render();}}root.addEventListener('scroll', render);window.addEventListener('resize', render);render();}const tables = document.querySelectorAll('.odr-virtual-table');for (let i = 0; i < tables.length; ++i) {init(tables[i]);}})();)V0G0N";
+  // clang-format on
+}
+
 std::string Html::body_attributes(const HtmlConfig &config) noexcept {
   std::string result;
 
@@ -133,4 +168,19 @@ std::string Html::escape_text(std::string text) noexcept {
   return text;
 }
 
+std::unordered_map<std::string, std::string> Html::style_classes(
+    const std::unordered_map<std::string, std::list<std::string>>
+        &dependencies) {
+  std::unordered_map<std::string, std::string> result;
+  result.reserve(dependencies.size());
+  std::vector<const std::string *> visited;
+  for (auto &&d : dependencies) {
+    std::string classes = d.first;
+    visited.assign({&d.first});
+    append_dependencies(dependencies, d.first, visited, classes);
+    result.emplace(d.first, std::move(classes));
+  }
+  return result;
+}
+
 } // namespace odr::internal::common
@@ -1,7 +1,9 @@
 #ifndef ODR_INTERNAL_COMMON_HTML_H
 #define ODR_INTERNAL_COMMON_HTML_H
 
+#include <list>
 #include <string>
+#include <unordered_map>
 
 namespace odr {
 struct HtmlConfig;
@@ -16,10 +18,18 @@ const char *default_style() noexcept;
 const char *default_spreadsheet_style() noexcept;
 
 const char *default_script() noexcept;
+// renders the payload of virtualized tables; see `TableData`
+const char *virtual_table_script() noexcept;
 
 std::string body_attributes(const HtmlConfig &config) noexcept;
 
 std::string escape_text(std::string text) noexcept;
+
+// flattens the style dependency graph into one ready to use class attribute
+// value per style; the style itself followed by all of its dependencies
+std::unordered_map<std::string, std::string> style_classes(
+    const std::unordered_map<std::string, std::list<std::string>>
+        &dependencies);
 } // namespace odr::internal::common::Html
 
 #endif // ODR_INTERNAL_COMMON_HTML_H
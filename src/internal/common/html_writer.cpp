@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <internal/common/html_writer.h>
+#include <internal/util/base64_util.h>
+#include <internal/util/number_util.h>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace odr::internal::common {
+
+namespace {
+const char *escape(const char c) noexcept {
+  switch (c) {
+  case '&':
+    return "&amp;";
+  case '<':
+    return "&lt;";
+  case '>':
+    return "&gt;";
+  default:
+    return nullptr;
+  }
+}
+
+// finds the next character which needs to be escaped
+const char *find_escape(const char *begin, const char *end) noexcept {
+#ifdef __SSE2__
+  const __m128i amp = _mm_set1_epi8('&');
+  const __m128i lt = _mm_set1_epi8('<');
+  const __m128i gt = _mm_set1_epi8('>');
+  while (end - begin >= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    const __m128i match =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, amp),
+                                  _mm_cmpeq_epi8(chunk, lt)),
+                     _mm_cmpeq_epi8(chunk, gt));
+    const int mask = _mm_movemask_epi8(match);
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 16;
+  }
+#endif
+  for (; begin != end; ++begin) {
+    if ((*begin == '&') || (*begin == '<') || (*begin == '>')) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+// multiple of three so that only the last chunk is padded
+constexpr std::size_t base64_chunk_size = 12 * 1024;
+} // namespace
+
+HtmlWriter::HtmlWriter()
+    : m_capacity{std::numeric_limits<std::size_t>::max()} {}
+
+HtmlWriter::HtmlWriter(std::ostream &sink, const std::size_t capacity)
+    : m_sink{&sink}, m_capacity{capacity} {
+  m_buffer.reserve(capacity);
+}
+
+HtmlWriter::~HtmlWriter() { flush_(); }
+
+HtmlWriter &HtmlWriter::operator<<(const double number) {
+  char buffer[util::number::max_length];
+  const char *end = util::number::to_chars(buffer, number, default_precision);
+  return write(std::string_view(buffer, end - buffer));
+}
+
+HtmlWriter &HtmlWriter::write(const std::string_view string) {
+  if (m_buffer.size() + string.size() > m_capacity) {
+    flush_();
+    if (string.size() > m_capacity) {
+      m_sink->write(string.data(), string.size());
+      return *this;
+    }
+  }
+  m_buffer.append(string);
+  return *this;
+}
+
+HtmlWriter &HtmlWriter::write_escaped(const std::string_view string) {
+  const char *begin = string.data();
+  const char *end = begin + string.size();
+  while (true) {
+    const char *next = find_escape(begin, end);
+    write(std::string_view(begin, next - begin));
+    if (next == end) {
+      break;
+    }
+    write(escape(*next));
+    begin = next + 1;
+  }
+  return *this;
+}
+
+HtmlWriter &HtmlWriter::write_base64(const std::string_view data) {
+  const char *begin = data.data();
+  const char *end = begin + data.size();
+  while (begin != end) {
+    const char *next =
+        begin + std::min<std::size_t>(end - begin, base64_chunk_size);
+    write_base64_(begin, next);
+    begin = next;
+  }
+  return *this;
+}
+
+HtmlWriter &HtmlWriter::write_base64(std::istream &in) {
+  char chunk[base64_chunk_size];
+  while (in) {
+    in.read(chunk, base64_chunk_size);
+    if (in.gcount() <= 0) {
+      break;
+    }
+    write_base64_(chunk, chunk + in.gcount());
+  }
+  return *this;
+}
+
+void HtmlWriter::flush() {
+  flush_();
+  if (m_sink != nullptr) {
+    m_sink->flush();
+  }
+}
+
+const std::string &HtmlWriter::str() const noexcept { return m_buffer; }
+
+void HtmlWriter::clear() noexcept { m_buffer.clear(); }
+
+void HtmlWriter::write_base64_(const char *begin, const char *end) {
+  const std::size_t length = util::base64::encoded_length(end - begin);
+  if (m_buffer.size() + length > m_capacity) {
+    flush_();
+  }
+  const std::size_t offset = m_buffer.size();
+  m_buffer.resize(offset + length);
+  util::base64::encode(begin, end, m_buffer.data() + offset);
+}
+
+void HtmlWriter::flush_() {
+  if ((m_sink == nullptr) || m_buffer.empty()) {
+    return;
+  }
+  m_sink->write(m_buffer.data(), m_buffer.size());
+  m_buffer.clear();
+}
+
+} // namespace odr::internal::common
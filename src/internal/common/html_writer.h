@@ -0,0 +1,84 @@
+#ifndef ODR_INTERNAL_COMMON_HTML_WRITER_H
+#define ODR_INTERNAL_COMMON_HTML_WRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace odr::internal::common {
+
+// output sink of the translators; collects everything in one contiguous
+// buffer which is handed to `sink` whenever it runs full
+class HtmlWriter final {
+public:
+  static constexpr std::size_t default_capacity = 64 * 1024;
+  // fractional digits of floating point numbers
+  static constexpr std::uint32_t default_precision = 6;
+
+  // keeps everything in memory; see `str()`
+  HtmlWriter();
+  explicit HtmlWriter(std::ostream &sink,
+                      std::size_t capacity = default_capacity);
+  HtmlWriter(const HtmlWriter &) = delete;
+  HtmlWriter(HtmlWriter &&) = delete;
+  ~HtmlWriter();
+  HtmlWriter &operator=(const HtmlWriter &) = delete;
+  HtmlWriter &operator=(HtmlWriter &&) = delete;
+
+  HtmlWriter &operator<<(char c) {
+    if (m_buffer.size() >= m_capacity) {
+      flush_();
+    }
+    m_buffer.push_back(c);
+    return *this;
+  }
+  HtmlWriter &operator<<(const char *string) {
+    return write(std::string_view(string));
+  }
+  HtmlWriter &operator<<(const std::string &string) {
+    return write(std::string_view(string));
+  }
+  HtmlWriter &operator<<(std::string_view string) { return write(string); }
+  HtmlWriter &operator<<(double number);
+
+  template <typename Integer,
+            typename = std::enable_if_t<std::is_integral_v<Integer> &&
+                                        !std::is_same_v<Integer, char> &&
+                                        !std::is_same_v<Integer, bool>>>
+  HtmlWriter &operator<<(const Integer number) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    return write(std::string_view(buffer, result.ptr - buffer));
+  }
+
+  HtmlWriter &write(std::string_view string);
+  // writes `string` with `&`, `<` and `>` replaced by their entities
+  HtmlWriter &write_escaped(std::string_view string);
+  // base64 encodes into the buffer; streams are consumed chunk by chunk
+  HtmlWriter &write_base64(std::string_view data);
+  HtmlWriter &write_base64(std::istream &in);
+
+  // hands the buffered output to the sink
+  void flush();
+
+  // everything written so far; only for writers without sink
+  [[nodiscard]] const std::string &str() const noexcept;
+  // drops everything written so far; only for writers without sink
+  void clear() noexcept;
+
+private:
+  std::ostream *m_sink{nullptr};
+  std::size_t m_capacity;
+  std::string m_buffer;
+
+  void flush_();
+  void write_base64_(const char *begin, const char *end);
+};
+
+} // namespace odr::internal::common
+
+#endif // ODR_INTERNAL_COMMON_HTML_WRITER_H
@@ -0,0 +1,104 @@
+#ifndef ODR_INTERNAL_COMMON_LRU_CACHE_H
+#define ODR_INTERNAL_COMMON_LRU_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace odr::internal::common {
+
+// least recently used cache limited by the summed cost of its values, e.g.
+// their size in bytes. values are shared so they stay valid after eviction.
+// can be shared by threads
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache final {
+public:
+  explicit LruCache(const std::size_t budget) : m_budget{budget} {}
+
+  // null if `key` is not cached
+  [[nodiscard]] std::shared_ptr<const Value> find(const Key &key) {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_index.find(key);
+    if (it == std::end(m_index)) {
+      return {};
+    }
+    m_entries.splice(std::begin(m_entries), m_entries, it->second);
+    return it->second->value;
+  }
+
+  // values costing more than the budget are returned without being cached
+  std::shared_ptr<const Value> insert(const Key &key, Value value,
+                                      const std::size_t cost) {
+    auto result = std::make_shared<const Value>(std::move(value));
+
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_index.find(key); it != std::end(m_index)) {
+      m_cost -= it->second->cost;
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    }
+    if (cost > m_budget) {
+      return result;
+    }
+    m_entries.push_front({key, result, cost});
+    m_index.emplace(key, std::begin(m_entries));
+    m_cost += cost;
+    evict_();
+    return result;
+  }
+
+  void budget(const std::size_t budget) {
+    std::lock_guard lock(m_mutex);
+    m_budget = budget;
+    evict_();
+  }
+
+  void clear() {
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_cost = 0;
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+  }
+
+  [[nodiscard]] std::size_t cost() const {
+    std::lock_guard lock(m_mutex);
+    return m_cost;
+  }
+
+private:
+  struct Entry {
+    Key key;
+    std::shared_ptr<const Value> value;
+    std::size_t cost;
+  };
+
+  mutable std::mutex m_mutex;
+  std::size_t m_budget;
+  std::size_t m_cost{0};
+  // most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+
+  void evict_() {
+    while (m_cost > m_budget) {
+      const Entry &last = m_entries.back();
+      m_cost -= last.cost;
+      m_index.erase(last.key);
+      m_entries.pop_back();
+    }
+  }
+};
+
+} // namespace odr::internal::common
+
+#endif // ODR_INTERNAL_COMMON_LRU_CACHE_H
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <internal/abstract/file.h>
+#include <internal/abstract/filesystem.h>
+#include <internal/common/file.h>
+#include <internal/common/path.h>
+#include <internal/common/resource_writer.h>
+#include <internal/crypto/crypto_util.h>
+#include <internal/util/stream_util.h>
+#include <internal/zip/zip_util.h>
+#include <odr/exceptions.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace odr::internal::common {
+
+namespace {
+// the name ends up in html attributes and urls unescaped
+bool plain_extension(const std::string_view extension) {
+  return !extension.empty() &&
+         std::all_of(std::begin(extension), std::end(extension), [](char c) {
+           return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+                  ('0' <= c && c <= '9');
+         });
+}
+
+// hex encoded sha256 of the content; unusual extensions are dropped
+class FileName final {
+public:
+  FileName() : m_hasher{crypto::util::HashAlgorithm::SHA256} {}
+
+  FileName &update(const std::string_view content) {
+    m_hasher.update(content);
+    return *this;
+  }
+
+  FileName &update(std::istream &in) {
+    char buffer[64 * 1024];
+    while (in) {
+      in.read(buffer, sizeof(buffer));
+      m_hasher.update(buffer, in.gcount());
+    }
+    if (in.bad()) {
+      throw FileReadError();
+    }
+    return *this;
+  }
+
+  std::string final(const std::string_view extension) {
+    static constexpr char digits[] = "0123456789abcdef";
+    unsigned char digest[crypto::util::max_digest_size];
+    const std::size_t size = m_hasher.digest_size();
+    m_hasher.final(digest);
+
+    std::string result;
+    result.reserve(2 * size + 1 + extension.size());
+    for (std::size_t i = 0; i < size; ++i) {
+      result += digits[digest[i] >> 4];
+      result += digits[digest[i] & 0xf];
+    }
+    if (plain_extension(extension)) {
+      result += '.';
+      result += extension;
+    }
+    return result;
+  }
+
+private:
+  crypto::util::Hasher m_hasher;
+};
+
+void write_file(const std::filesystem::path &path,
+                const std::string_view content) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out.is_open()) {
+    throw FileNotCreated();
+  }
+  out.write(content.data(), content.size());
+}
+
+void write_file(const std::filesystem::path &path, std::istream &in) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out.is_open()) {
+    throw FileNotCreated();
+  }
+  util::stream::pipe(in, out);
+}
+
+// copies `size` bytes at `offset` of `from` inside of the kernel; the blocks
+// might even get shared. false if that is not possible here
+bool copy_range(const std::filesystem::path &from, const std::uint64_t offset,
+                std::uint64_t size, const std::filesystem::path &to) {
+#ifdef __linux__
+  const int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in < 0) {
+    return false;
+  }
+  const int out =
+      ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (out < 0) {
+    ::close(in);
+    return false;
+  }
+  auto in_offset = static_cast<off_t>(offset);
+  while (size > 0) {
+    const ssize_t result =
+        ::copy_file_range(in, &in_offset, out, nullptr, size, 0);
+    if (result <= 0) {
+      break;
+    }
+    size -= result;
+  }
+  ::close(in);
+  ::close(out);
+  return size == 0;
+#else
+  return false;
+#endif
+}
+} // namespace
+
+ResourceWriter::ResourceWriter(std::filesystem::path directory,
+                               std::string url)
+    : m_directory{std::move(directory)}, m_url{std::move(url)} {
+  if (!m_url.empty() && (m_url.back() != '/')) {
+    m_url += '/';
+  }
+}
+
+std::string
+ResourceWriter::write(const abstract::ReadableFilesystem &filesystem,
+                      const Path &path) {
+  {
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_parts.find(path.string()); it != std::end(m_parts)) {
+      return it->second;
+    }
+  }
+
+  const auto file = filesystem.open(path);
+  if (!file) {
+    throw FileNotFound();
+  }
+
+  std::string name;
+  const auto zip_file = std::dynamic_pointer_cast<zip::util::FileInZip>(file);
+  const auto disc_file =
+      zip_file ? std::dynamic_pointer_cast<DiscFile>(zip_file->archive_file())
+               : nullptr;
+  if (disc_file && !zip_file->compressed()) {
+    // stored as it is; hashed while streaming and copied inside of the kernel
+    name = FileName().update(*file->read()).final(path.extension());
+    if (claim_(name)) {
+      write_(name, [&] {
+        if (!copy_range(disc_file->path().path(), zip_file->data_offset(),
+                        zip_file->size(), m_directory / name)) {
+          write_file(m_directory / name, *file->read());
+        }
+      });
+    }
+  } else {
+    const std::string content = util::stream::read(*file->read());
+    name = FileName().update(content).final(path.extension());
+    if (claim_(name)) {
+      write_(name, [&] { write_file(m_directory / name, content); });
+    }
+  }
+
+  std::lock_guard lock(m_mutex);
+  return m_parts[path.string()] = m_url + name;
+}
+
+std::string ResourceWriter::write(const std::string_view content,
+                                  const std::string_view extension) {
+  const std::string name = FileName().update(content).final(extension);
+  if (claim_(name)) {
+    write_(name, [&] { write_file(m_directory / name, content); });
+  }
+  return m_url + name;
+}
+
+bool ResourceWriter::claim_(const std::string &name) {
+  std::lock_guard lock(m_mutex);
+  if (m_files.empty()) {
+    std::filesystem::create_directories(m_directory);
+  }
+  return m_files.insert(name).second;
+}
+
+void ResourceWriter::write_(const std::string &name,
+                           const std::function<void()> &write) {
+  try {
+    write();
+  } catch (...) {
+    std::lock_guard lock(m_mutex);
+    m_files.erase(name);
+    throw;
+  }
+}
+
+} // namespace odr::internal::common
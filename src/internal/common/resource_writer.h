@@ -0,0 +1,52 @@
+#ifndef ODR_INTERNAL_COMMON_RESOURCE_WRITER_H
+#define ODR_INTERNAL_COMMON_RESOURCE_WRITER_H
+
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace odr::internal::abstract {
+class ReadableFilesystem;
+} // namespace odr::internal::abstract
+
+namespace odr::internal::common {
+class Path;
+
+// writes the media referenced by the output as files next to it instead of
+// inlining them. the files are named by the sha256 of their content so each
+// of them is written once. can be shared by threads; the files are written
+// outside of the lock
+class ResourceWriter final {
+public:
+  // `url` prefixes the references to the files inside of `directory`
+  ResourceWriter(std::filesystem::path directory, std::string url);
+
+  // reference to the part `path` of `filesystem`
+  std::string write(const abstract::ReadableFilesystem &filesystem,
+                    const Path &path);
+  // reference to generated content like converted metafiles
+  std::string write(std::string_view content, std::string_view extension);
+
+private:
+  std::filesystem::path m_directory;
+  std::string m_url;
+
+  std::mutex m_mutex;
+  // part path to reference
+  std::unordered_map<std::string, std::string> m_parts;
+  std::unordered_set<std::string> m_files;
+
+  // true if `name` is new and has to be written by the caller; creates the
+  // directory before the first file
+  bool claim_(const std::string &name);
+  // calls `write` and gives up the claim on `name` if it fails
+  void write_(const std::string &name, const std::function<void()> &write);
+};
+
+} // namespace odr::internal::common
+
+#endif // ODR_INTERNAL_COMMON_RESOURCE_WRITER_H
@@ -0,0 +1,350 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <internal/common/file.h>
+#include <internal/common/spill_file.h>
+#include <istream>
+#include <odr/exceptions.h>
+#include <odr/file_location.h>
+#include <streambuf>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace odr::internal::common {
+
+namespace {
+constexpr std::size_t default_process_limit = 1024 * 1024 * 1024;
+constexpr std::size_t default_document_limit = 256 * 1024 * 1024;
+
+std::atomic<std::size_t> document_limit_{default_document_limit};
+} // namespace
+
+MemoryBudget &MemoryBudget::process() noexcept {
+  static MemoryBudget budget(default_process_limit, nullptr);
+  return budget;
+}
+
+void MemoryBudget::document_limit(const std::size_t limit) noexcept {
+  document_limit_ = limit;
+}
+
+std::size_t MemoryBudget::document_limit() noexcept { return document_limit_; }
+
+MemoryBudget::MemoryBudget() : MemoryBudget(document_limit(), &process()) {}
+
+MemoryBudget::MemoryBudget(const std::size_t limit, MemoryBudget *parent)
+    : m_parent{parent}, m_limit{limit} {}
+
+void MemoryBudget::limit(const std::size_t limit) noexcept { m_limit = limit; }
+
+std::size_t MemoryBudget::limit() const noexcept { return m_limit; }
+
+std::size_t MemoryBudget::used() const noexcept { return m_used; }
+
+bool MemoryBudget::reserve(const std::size_t size) noexcept {
+  std::size_t used = m_used;
+  do {
+    const std::size_t limit = m_limit;
+    if ((size > limit) || (used > limit - size)) {
+      return false;
+    }
+  } while (!m_used.compare_exchange_weak(used, used + size));
+
+  if ((m_parent != nullptr) && !m_parent->reserve(size)) {
+    m_used -= size;
+    return false;
+  }
+  return true;
+}
+
+void MemoryBudget::release(const std::size_t size) noexcept {
+  m_used -= size;
+  if (m_parent != nullptr) {
+    m_parent->release(size);
+  }
+}
+
+struct SpillFile::Content {
+  std::shared_ptr<MemoryBudget> budget;
+  // reserved for `memory`
+  std::size_t reserved{0};
+  std::string memory;
+  // the content was not kept in memory
+  bool disc{false};
+  // file mapped into memory
+  const char *mapping{nullptr};
+  std::size_t size{0};
+
+  Content() = default;
+  Content(const Content &) = delete;
+  Content &operator=(const Content &) = delete;
+
+  ~Content() {
+#ifdef __linux__
+    if (mapping != nullptr) {
+      ::munmap(const_cast<char *>(mapping), size);
+    }
+#endif
+    if (budget) {
+      budget->release(reserved);
+    }
+  }
+
+  [[nodiscard]] std::string_view view() const noexcept {
+    if (mapping != nullptr) {
+      return {mapping, size};
+    }
+    return memory;
+  }
+};
+
+namespace {
+constexpr std::size_t chunk_size = 64 * 1024;
+
+using FilePtr = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+// only accessible by this process and removed once closed
+FilePtr temporary_file() {
+#ifdef __linux__
+  std::string path =
+      (std::filesystem::temp_directory_path() / "odr-XXXXXX").string();
+  // creates the file exclusively with mode 0600
+  const int fd = ::mkostemp(path.data(), O_CLOEXEC);
+  if (fd < 0) {
+    throw FileNotCreated();
+  }
+  ::unlink(path.c_str());
+  FilePtr file(::fdopen(fd, "w+b"), std::fclose);
+  if (!file) {
+    ::close(fd);
+    throw FileNotCreated();
+  }
+  return file;
+#else
+  FilePtr file(std::tmpfile(), std::fclose);
+  if (!file) {
+    throw FileNotCreated();
+  }
+  return file;
+#endif
+}
+
+// maps `size` bytes of `fd` into `content`
+void map_file(SpillFile::Content &content, const int fd) {
+#ifdef __linux__
+  void *mapping = ::mmap(nullptr, content.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    throw FileReadError();
+  }
+  content.mapping = static_cast<const char *>(mapping);
+#endif
+}
+
+// appends to the content and moves it to a temporary file once it does not
+// fit into the budget anymore
+class ContentWriter final {
+public:
+  explicit ContentWriter(SpillFile::Content &content) : m_content{content} {}
+
+  void write(const char *data, const std::size_t size) {
+    m_content.size += size;
+    if (!m_file && m_content.budget->reserve(size)) {
+      m_content.reserved += size;
+      m_content.memory.append(data, size);
+      return;
+    }
+    if (!m_file) {
+      spill_();
+    }
+    write_(data, size);
+  }
+
+  void write(std::istream &in) {
+    char buffer[chunk_size];
+    while (in) {
+      in.read(buffer, sizeof(buffer));
+      if (in.gcount() <= 0) {
+        break;
+      }
+      write(buffer, in.gcount());
+    }
+    // streams report read errors by setting `badbit`
+    if (in.bad()) {
+      throw FileReadError();
+    }
+  }
+
+  void close() {
+    if (!m_file) {
+      return;
+    }
+    if (std::fflush(m_file.get()) != 0) {
+      throw FileNotCreated();
+    }
+    if (m_content.size > 0) {
+#ifdef __linux__
+      map_file(m_content, ::fileno(m_file.get()));
+#else
+      // the content has to be contiguous
+      std::rewind(m_file.get());
+      m_content.memory.resize(m_content.size);
+      if (std::fread(m_content.memory.data(), 1, m_content.size,
+                     m_file.get()) != m_content.size) {
+        throw FileReadError();
+      }
+#endif
+    }
+    m_file.reset();
+  }
+
+private:
+  SpillFile::Content &m_content;
+  FilePtr m_file{nullptr, std::fclose};
+
+  void spill_() {
+    m_file = temporary_file();
+    m_content.disc = true;
+
+    write_(m_content.memory.data(), m_content.memory.size());
+    m_content.budget->release(m_content.reserved);
+    m_content.reserved = 0;
+    m_content.memory = std::string();
+  }
+
+  void write_(const char *data, const std::size_t size) {
+    if (std::fwrite(data, 1, size, m_file.get()) != size) {
+      throw FileNotCreated();
+    }
+  }
+};
+
+class ContentBuffer final : public std::streambuf {
+public:
+  explicit ContentBuffer(std::shared_ptr<const SpillFile::Content> content)
+      : m_content{std::move(content)} {
+    const std::string_view view = m_content->view();
+    char *begin = const_cast<char *>(view.data());
+    setg(begin, begin, begin + view.size());
+  }
+
+protected:
+  pos_type seekoff(const off_type offset, const std::ios_base::seekdir dir,
+                   const std::ios_base::openmode which) final {
+    off_type base = 0;
+    if (dir == std::ios_base::cur) {
+      base = gptr() - eback();
+    } else if (dir == std::ios_base::end) {
+      base = egptr() - eback();
+    }
+    return seekpos(base + offset, which);
+  }
+
+  pos_type seekpos(const pos_type position,
+                   const std::ios_base::openmode which) final {
+    if (((which & std::ios_base::in) == 0) || (position < 0) ||
+        (position > egptr() - eback())) {
+      return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + off_type(position), egptr());
+    return position;
+  }
+
+private:
+  std::shared_ptr<const SpillFile::Content> m_content;
+};
+
+class ContentIstream final : public std::istream {
+public:
+  explicit ContentIstream(std::unique_ptr<ContentBuffer> sbuf)
+      : std::istream(sbuf.get()), m_sbuf{std::move(sbuf)} {}
+
+private:
+  std::unique_ptr<ContentBuffer> m_sbuf;
+};
+} // namespace
+
+SpillFile::SpillFile(std::istream &in, std::shared_ptr<MemoryBudget> budget) {
+  auto content = std::make_shared<Content>();
+  content->budget = std::move(budget);
+  ContentWriter writer(*content);
+  writer.write(in);
+  writer.close();
+  m_content = std::move(content);
+}
+
+SpillFile::SpillFile(const abstract::File &file,
+                     std::shared_ptr<MemoryBudget> budget) {
+  auto content = std::make_shared<Content>();
+  content->budget = std::move(budget);
+  const std::size_t size = file.size();
+  const auto in = file.read();
+
+  // read in one go if the size is known to fit
+  if (content->budget->reserve(size)) {
+    content->reserved = size;
+    content->size = size;
+    content->memory.resize(size);
+    in->read(content->memory.data(), size);
+    if (static_cast<std::size_t>(in->gcount()) != size) {
+      throw FileReadError();
+    }
+  } else {
+    ContentWriter writer(*content);
+    writer.write(*in);
+    writer.close();
+    if (content->size != size) {
+      throw FileReadError();
+    }
+  }
+  m_content = std::move(content);
+}
+
+#ifdef __linux__
+SpillFile::SpillFile(const DiscFile &file, std::shared_ptr<MemoryBudget>) {
+  // mapped as it is, without a copy
+  auto content = std::make_shared<Content>();
+  content->disc = true;
+  content->size = file.size();
+  if (content->size > 0) {
+    const std::string path = file.path().string();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw FileReadError();
+    }
+    try {
+      map_file(*content, fd);
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+  m_content = std::move(content);
+}
+#else
+SpillFile::SpillFile(const DiscFile &file, std::shared_ptr<MemoryBudget> budget)
+    : SpillFile(static_cast<const abstract::File &>(file), std::move(budget)) {}
+#endif
+
+FileLocation SpillFile::location() const noexcept {
+  return m_content->disc ? FileLocation::DISC : FileLocation::MEMORY;
+}
+
+std::size_t SpillFile::size() const { return m_content->size; }
+
+std::unique_ptr<std::istream> SpillFile::read() const {
+  return std::make_unique<ContentIstream>(
+      std::make_unique<ContentBuffer>(m_content));
+}
+
+std::string_view SpillFile::content() const noexcept {
+  return m_content->view();
+}
+
+} // namespace odr::internal::common
@@ -0,0 +1,75 @@
+#ifndef ODR_INTERNAL_COMMON_SPILL_FILE_H
+#define ODR_INTERNAL_COMMON_SPILL_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <internal/abstract/file.h>
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+namespace odr {
+enum class FileLocation;
+}
+
+namespace odr::internal::common {
+class DiscFile;
+
+// bytes the buffers of e.g. one document may keep in memory. a budget can be
+// nested into another one; a reservation has to fit into both of them. can be
+// shared by threads
+class MemoryBudget final {
+public:
+  // shared by all documents of the process
+  static MemoryBudget &process() noexcept;
+  // limit of the document budgets created from now on
+  static void document_limit(std::size_t limit) noexcept;
+  [[nodiscard]] static std::size_t document_limit() noexcept;
+
+  // document budget nested into the process budget
+  MemoryBudget();
+  MemoryBudget(std::size_t limit, MemoryBudget *parent);
+  MemoryBudget(const MemoryBudget &) = delete;
+  MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+  void limit(std::size_t limit) noexcept;
+  [[nodiscard]] std::size_t limit() const noexcept;
+  [[nodiscard]] std::size_t used() const noexcept;
+
+  // false if `size` does not fit; nothing is reserved then
+  [[nodiscard]] bool reserve(std::size_t size) noexcept;
+  void release(std::size_t size) noexcept;
+
+private:
+  MemoryBudget *m_parent{nullptr};
+  std::atomic<std::size_t> m_limit;
+  std::atomic<std::size_t> m_used{0};
+};
+
+// buffer for intermediate content like a decrypted package. the content is
+// kept in memory as long as it fits into the budget; otherwise it is moved to
+// a temporary file which is mapped into memory where possible
+class SpillFile final : public abstract::File {
+public:
+  // reads `in` to its end
+  SpillFile(std::istream &in, std::shared_ptr<MemoryBudget> budget);
+  SpillFile(const abstract::File &file, std::shared_ptr<MemoryBudget> budget);
+  // maps the file directly where possible
+  SpillFile(const DiscFile &file, std::shared_ptr<MemoryBudget> budget);
+
+  [[nodiscard]] FileLocation location() const noexcept final;
+  [[nodiscard]] std::size_t size() const final;
+  [[nodiscard]] std::unique_ptr<std::istream> read() const final;
+
+  // valid as long as the file
+  [[nodiscard]] std::string_view content() const noexcept;
+
+  struct Content;
+
+private:
+  std::shared_ptr<const Content> m_content;
+};
+
+} // namespace odr::internal::common
+
+#endif // ODR_INTERNAL_COMMON_SPILL_FILE_H
@@ -48,6 +48,15 @@ std::uint32_t TableCursor::row() const noexcept { return m_row; }
 
 std::uint32_t TableCursor::col() const noexcept { return m_col; }
 
+bool TableCursor::spanned() const noexcept {
+  for (auto &&s : m_sparse) {
+    if (!s.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void TableCursor::handle_rowspan_() noexcept {
   auto &s = m_sparse.front();
   auto it = std::begin(s);
@@ -19,6 +19,8 @@ public:
   TablePosition position() const noexcept;
   std::uint32_t row() const noexcept;
   std::uint32_t col() const noexcept;
+  // true if rowspans of previous cells reach into this or upcoming rows
+  bool spanned() const noexcept;
 
 private:
   struct Range {
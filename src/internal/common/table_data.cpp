@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <internal/common/html_writer.h>
+#include <internal/common/table_data.h>
+
+namespace odr::internal::common {
+
+namespace {
+// escapes for a JSON string inside of a `<script>` element
+void write_json_string(const std::string_view string, HtmlWriter &out) {
+  constexpr char hex[] = "0123456789abcdef";
+
+  out << '"';
+  std::size_t begin = 0;
+  for (std::size_t i = 0; i < string.size(); ++i) {
+    const auto c = static_cast<unsigned char>(string[i]);
+    if ((c >= 0x20) && (c != '"') && (c != '\\') && (c != '<')) {
+      continue;
+    }
+    out.write(string.substr(begin, i - begin));
+    begin = i + 1;
+    if (c == '"') {
+      out << "\\\"";
+    } else if (c == '\\') {
+      out << "\\\\";
+    } else {
+      out << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+    }
+  }
+  out.write(string.substr(begin));
+  out << '"';
+}
+} // namespace
+
+void TableData::add_column(const std::uint32_t col, const std::uint32_t span,
+                           const std::string_view attributes,
+                           const std::string_view cell_attributes) {
+  m_columns.push_back(
+      {col, span, intern_(attributes), intern_(cell_attributes)});
+  m_cols = std::max(m_cols, col + span);
+}
+
+void TableData::add_row(const std::uint32_t row,
+                        const std::string_view attributes) {
+  if (attributes.empty()) {
+    return;
+  }
+  m_rows.push_back({row, intern_(attributes)});
+}
+
+void TableData::add_cell(const std::uint32_t row, const std::uint32_t col,
+                         const std::uint32_t colspan,
+                         const std::uint32_t rowspan,
+                         const std::string_view attributes,
+                         const std::string_view content) {
+  m_cells.push_back({row, col, colspan, rowspan, intern_(attributes),
+                     intern_(content)});
+  m_cols = std::max(m_cols, col + colspan);
+}
+
+TableData::Mark TableData::mark() const noexcept {
+  return {m_rows.size(), m_cells.size()};
+}
+
+void TableData::repeat(const Mark begin, const Mark end,
+                       const std::uint32_t offset) {
+  for (std::size_t i = begin.rows; i < end.rows; ++i) {
+    Row row = m_rows[i];
+    row.row += offset;
+    m_rows.push_back(row);
+  }
+  for (std::size_t i = begin.cells; i < end.cells; ++i) {
+    Cell cell = m_cells[i];
+    cell.row += offset;
+    m_cells.push_back(cell);
+  }
+}
+
+void TableData::write(const std::string_view table_attributes,
+                      const std::uint32_t rows, HtmlWriter &out) const {
+  out << R"(<div class="odr-virtual-table")"
+      << R"( style="overflow:auto;height:100vh">)";
+  out << R"(<div class="odr-virtual-top"></div>)";
+  out << "<table" << table_attributes;
+  out << "><colgroup></colgroup><tbody></tbody></table>";
+  out << R"(<div class="odr-virtual-bottom"></div>)";
+
+  out << R"(<script type="application/json">)";
+  out << R"({"rows":)" << rows << R"(,"cols":)" << m_cols;
+
+  out << R"(,"strings":[)";
+  for (std::size_t i = 0; i < m_strings.size(); ++i) {
+    if (i > 0) {
+      out << ',';
+    }
+    write_json_string(m_strings[i], out);
+  }
+
+  // flat arrays of fixed size records
+  out << R"(],"columns":[)";
+  for (std::size_t i = 0; i < m_columns.size(); ++i) {
+    const Column &c = m_columns[i];
+    out << (i > 0 ? "," : "") << c.col << ',' << c.span << ','
+        << c.attributes << ',' << c.cell_attributes;
+  }
+  out << R"(],"rowAttributes":[)";
+  for (std::size_t i = 0; i < m_rows.size(); ++i) {
+    const Row &r = m_rows[i];
+    out << (i > 0 ? "," : "") << r.row << ',' << r.attributes;
+  }
+  out << R"(],"cells":[)";
+  for (std::size_t i = 0; i < m_cells.size(); ++i) {
+    const Cell &c = m_cells[i];
+    out << (i > 0 ? "," : "") << c.row << ',' << c.col << ',' << c.colspan
+        << ',' << c.rowspan << ',' << c.attributes << ',' << c.content;
+  }
+  out << "]}";
+  out << "</script></div>";
+}
+
+std::uint32_t TableData::intern_(const std::string_view string) {
+  if (m_strings.empty()) {
+    m_strings.emplace_back();
+    m_string_index.emplace(m_strings.back(), 0);
+  }
+  if (const auto it = m_string_index.find(string);
+      it != std::end(m_string_index)) {
+    return it->second;
+  }
+  const auto index = static_cast<std::uint32_t>(m_strings.size());
+  m_strings.emplace_back(string);
+  m_string_index.emplace(m_strings.back(), index);
+  return index;
+}
+
+} // namespace odr::internal::common
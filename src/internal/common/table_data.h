@@ -0,0 +1,78 @@
+#ifndef ODR_INTERNAL_COMMON_TABLE_DATA_H
+#define ODR_INTERNAL_COMMON_TABLE_DATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace odr::internal::common {
+class HtmlWriter;
+
+// cells of a spreadsheet table for the virtualized output; the table is
+// written as a compact JSON payload which is rendered viewport by viewport on
+// the client. see `Html::virtual_table_script`
+class TableData final {
+public:
+  // `attributes` is the attribute markup of the element e.g. ` class="a"`
+  void add_column(std::uint32_t col, std::uint32_t span,
+                  std::string_view attributes,
+                  std::string_view cell_attributes);
+  void add_row(std::uint32_t row, std::string_view attributes);
+  void add_cell(std::uint32_t row, std::uint32_t col, std::uint32_t colspan,
+                std::uint32_t rowspan, std::string_view attributes,
+                std::string_view content);
+
+  // position in the added rows and cells
+  struct Mark {
+    std::size_t rows;
+    std::size_t cells;
+  };
+
+  [[nodiscard]] Mark mark() const noexcept;
+  // adds the rows and cells between `begin` and `end` again, moved `offset`
+  // rows down
+  void repeat(Mark begin, Mark end, std::uint32_t offset);
+
+  // writes the scroll container with an empty table and the JSON payload;
+  // `table_attributes` go to the `<table>` element
+  void write(std::string_view table_attributes, std::uint32_t rows,
+             HtmlWriter &out) const;
+
+private:
+  struct Column {
+    std::uint32_t col;
+    std::uint32_t span;
+    std::uint32_t attributes;
+    std::uint32_t cell_attributes;
+  };
+  struct Row {
+    std::uint32_t row;
+    std::uint32_t attributes;
+  };
+  struct Cell {
+    std::uint32_t row;
+    std::uint32_t col;
+    std::uint32_t colspan;
+    std::uint32_t rowspan;
+    std::uint32_t attributes;
+    std::uint32_t content;
+  };
+
+  // deduplicated attribute markup and cell contents; index zero is empty
+  std::deque<std::string> m_strings;
+  std::unordered_map<std::string_view, std::uint32_t> m_string_index;
+  std::vector<Column> m_columns;
+  std::vector<Row> m_rows;
+  std::vector<Cell> m_cells;
+  std::uint32_t m_cols{0};
+
+  std::uint32_t intern_(std::string_view string);
+};
+
+} // namespace odr::internal::common
+
+#endif // ODR_INTERNAL_COMMON_TABLE_DATA_H
@@ -1,8 +1,26 @@
+#include <algorithm>
 #include <internal/common/table_position.h>
+#include <limits>
 #include <stdexcept>
 
 namespace odr::internal::common {
 
+namespace {
+// more letters would overflow the column
+constexpr std::size_t max_col_letters = 6;
+// more digits would overflow the 64 bit accumulator
+constexpr std::size_t max_row_digits = 19;
+
+// unsigned arithmetic turns the range checks into one comparison each
+bool is_upper(const char c) noexcept {
+  return static_cast<unsigned char>(c - 'A') < 26;
+}
+
+bool is_digit(const char c) noexcept {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+} // namespace
+
 std::uint32_t TablePosition::to_col_num(const std::string &string) {
   if (string.empty()) {
     throw std::invalid_argument("s is empty");
@@ -36,24 +54,58 @@ std::string TablePosition::to_col_string(std::uint32_t col) {
   return result;
 }
 
+std::optional<TablePosition>
+TablePosition::parse(const std::string_view string) noexcept {
+  const char *it = string.data();
+  const char *end = it + string.size();
+  const char *letters_end = it + std::min(string.size(), max_col_letters);
+
+  std::uint32_t col = 0;
+  for (; (it != letters_end) && is_upper(*it); ++it) {
+    col = col * 26 + (*it - 'A' + 1);
+  }
+  if (col == 0) {
+    return {};
+  }
+
+  const auto row = parse_row(std::string_view(it, end - it));
+  if (!row) {
+    return {};
+  }
+  return TablePosition(*row, col - 1);
+}
+
+std::optional<std::uint32_t>
+TablePosition::parse_row(const std::string_view string) noexcept {
+  if (string.empty() || (string.size() > max_row_digits)) {
+    return {};
+  }
+
+  std::uint64_t row = 0;
+  for (const char c : string) {
+    if (!is_digit(c)) {
+      return {};
+    }
+    row = row * 10 + (c - '0');
+  }
+  if ((row == 0) || (row > std::numeric_limits<std::uint32_t>::max())) {
+    return {};
+  }
+  return row - 1;
+}
+
 TablePosition::TablePosition() noexcept = default;
 
 TablePosition::TablePosition(const std::uint32_t row,
                              const std::uint32_t col) noexcept
     : m_row{row}, m_col{col} {}
 
-TablePosition::TablePosition(const std::string &s) {
-  const auto pos = s.find_first_of("0123456789");
-  if (pos == std::string::npos) {
-    throw std::invalid_argument("malformed table position " + s);
-  }
-  m_row = std::stoul(s.substr(pos));
-  if (m_row <= 0) {
-    throw std::invalid_argument("row number needs to be at least 1 " +
-                                s.substr(pos));
+TablePosition::TablePosition(const std::string_view s) {
+  const auto position = parse(s);
+  if (!position) {
+    throw std::invalid_argument("malformed table position " + std::string(s));
   }
-  --m_row;
-  m_col = to_col_num(s.substr(0, pos));
+  *this = *position;
 }
 
 std::uint32_t TablePosition::row() const noexcept { return m_row; }
@@ -2,7 +2,9 @@
 #define ODR_INTERNAL_COMMON_TABLE_POSITION_H
 
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace odr::internal::common {
 
@@ -11,9 +13,16 @@ public:
   static std::uint32_t to_col_num(const std::string &string);
   static std::string to_col_string(std::uint32_t col);
 
+  // A1 style reference like "AB12"; empty if malformed. does not allocate
+  [[nodiscard]] static std::optional<TablePosition>
+  parse(std::string_view string) noexcept;
+  // zero based row of a one based row number like "12"; empty if malformed
+  [[nodiscard]] static std::optional<std::uint32_t>
+  parse_row(std::string_view string) noexcept;
+
   TablePosition() noexcept;
   TablePosition(std::uint32_t row, std::uint32_t col) noexcept;
-  explicit TablePosition(const std::string &);
+  explicit TablePosition(std::string_view);
 
   [[nodiscard]] std::uint32_t row() const noexcept;
   [[nodiscard]] std::uint32_t col() const noexcept;
@@ -3,22 +3,97 @@
 #include <blowfish.h>
 #include <des.h>
 #include <filters.h>
+#include <hmac.h>
+#include <internal/common/lru_cache.h>
 #include <internal/crypto/crypto_util.h>
+#include <internal/util/base64_util.h>
 #include <modes.h>
+#include <osrng.h>
 #include <pwdbased.h>
 #include <sha.h>
+#include <stdexcept>
 #include <zinflate.h>
 
 namespace odr::internal::crypto {
 
 using byte = std::uint8_t;
 
+namespace {
+std::unique_ptr<CryptoPP::HashTransformation>
+hash_transformation(const util::HashAlgorithm algorithm) {
+  switch (algorithm) {
+  case util::HashAlgorithm::SHA1:
+    return std::make_unique<CryptoPP::SHA1>();
+  case util::HashAlgorithm::SHA256:
+    return std::make_unique<CryptoPP::SHA256>();
+  case util::HashAlgorithm::SHA384:
+    return std::make_unique<CryptoPP::SHA384>();
+  case util::HashAlgorithm::SHA512:
+    return std::make_unique<CryptoPP::SHA512>();
+  default:
+    throw std::invalid_argument("hash algorithm");
+  }
+}
+
+template <typename Cipher>
+std::unique_ptr<CryptoPP::SymmetricCipher>
+cipher(const std::string &key, const std::string &iv) {
+  auto result = std::make_unique<Cipher>();
+  result->SetKeyWithIV(reinterpret_cast<const byte *>(key.data()), key.size(),
+                       reinterpret_cast<const byte *>(iv.data()), iv.size());
+  return result;
+}
+
+// few entries suffice; a document has one key per encrypted part at most
+constexpr std::size_t key_cache_size = 256;
+
+common::LruCache<std::string, std::string> &key_cache() {
+  static common::LruCache<std::string, std::string> cache(key_cache_size);
+  return cache;
+}
+
+// keyed with a random secret of the process so that the cache does not hold
+// plain digests of the passwords
+std::string secret_digest(const std::string &secret) {
+  static const std::string key = util::random_bytes(32);
+  CryptoPP::HMAC<CryptoPP::SHA256> hmac(
+      reinterpret_cast<const byte *>(key.data()), key.size());
+  std::string result(CryptoPP::SHA256::DIGESTSIZE, '\0');
+  hmac.CalculateDigest(reinterpret_cast<byte *>(result.data()),
+                       reinterpret_cast<const byte *>(secret.data()),
+                       secret.size());
+  return result;
+}
+} // namespace
+
+util::Hasher::Hasher(const HashAlgorithm algorithm)
+    : m_impl{hash_transformation(algorithm)} {}
+
+util::Hasher::Hasher(Hasher &&) noexcept = default;
+
+util::Hasher::~Hasher() = default;
+
+util::Hasher &util::Hasher::operator=(Hasher &&) noexcept = default;
+
+std::size_t util::Hasher::digest_size() const noexcept {
+  return m_impl->DigestSize();
+}
+
+util::Hasher &util::Hasher::update(const void *data, const std::size_t size) {
+  m_impl->Update(static_cast<const byte *>(data), size);
+  return *this;
+}
+
+util::Hasher &util::Hasher::update(const std::string_view data) {
+  return update(data.data(), data.size());
+}
+
+void util::Hasher::final(void *digest) {
+  m_impl->Final(static_cast<byte *>(digest));
+}
+
 std::string util::base64_encode(const std::string &in) {
-  std::string out;
-  CryptoPP::Base64Encoder b(new CryptoPP::StringSink(out), false);
-  b.Put(reinterpret_cast<const byte *>(in.data()), in.size());
-  b.MessageEnd();
-  return out;
+  return internal::util::base64::encode(in);
 }
 
 std::string util::base64_decode(const std::string &in) {
@@ -44,6 +119,94 @@ std::string util::sha256(const std::string &in) {
                      CryptoPP::SHA256::DIGESTSIZE);
 }
 
+std::string util::sha384(const std::string &in) {
+  byte out[CryptoPP::SHA384::DIGESTSIZE];
+  CryptoPP::SHA384().CalculateDigest(
+      out, reinterpret_cast<const byte *>(in.data()), in.size());
+  return std::string(reinterpret_cast<char *>(out),
+                     CryptoPP::SHA384::DIGESTSIZE);
+}
+
+std::string util::sha512(const std::string &in) {
+  byte out[CryptoPP::SHA512::DIGESTSIZE];
+  CryptoPP::SHA512().CalculateDigest(
+      out, reinterpret_cast<const byte *>(in.data()), in.size());
+  return std::string(reinterpret_cast<char *>(out),
+                     CryptoPP::SHA512::DIGESTSIZE);
+}
+
+util::Decryptor::Decryptor(const CipherAlgorithm algorithm,
+                           const std::string &key, const std::string &iv) {
+  switch (algorithm) {
+  case CipherAlgorithm::AES_CBC:
+    m_impl = cipher<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption>(key, iv);
+    break;
+  case CipherAlgorithm::TRIPLE_DES_CBC:
+    m_impl = cipher<CryptoPP::CBC_Mode<CryptoPP::DES_EDE3>::Decryption>(
+        key, iv);
+    break;
+  case CipherAlgorithm::BLOWFISH_CFB:
+    m_impl = cipher<CryptoPP::CFB_Mode<CryptoPP::Blowfish>::Decryption>(
+        key, iv);
+    break;
+  default:
+    throw std::invalid_argument("cipher algorithm");
+  }
+}
+
+util::Decryptor::Decryptor(Decryptor &&) noexcept = default;
+
+util::Decryptor::~Decryptor() = default;
+
+util::Decryptor &util::Decryptor::operator=(Decryptor &&) noexcept = default;
+
+void util::Decryptor::process(const char *input, char *output,
+                              const std::size_t size) {
+  m_impl->ProcessData(reinterpret_cast<byte *>(output),
+                      reinterpret_cast<const byte *>(input), size);
+}
+
+util::Encryptor::Encryptor(const CipherAlgorithm algorithm,
+                           const std::string &key, const std::string &iv) {
+  switch (algorithm) {
+  case CipherAlgorithm::AES_CBC:
+    m_impl = cipher<CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption>(key, iv);
+    break;
+  case CipherAlgorithm::TRIPLE_DES_CBC:
+    m_impl = cipher<CryptoPP::CBC_Mode<CryptoPP::DES_EDE3>::Encryption>(
+        key, iv);
+    break;
+  default:
+    throw std::invalid_argument("cipher algorithm");
+  }
+}
+
+util::Encryptor::Encryptor(Encryptor &&) noexcept = default;
+
+util::Encryptor::~Encryptor() = default;
+
+util::Encryptor &util::Encryptor::operator=(Encryptor &&) noexcept = default;
+
+void util::Encryptor::process(const char *input, char *output,
+                              const std::size_t size) {
+  m_impl->ProcessData(reinterpret_cast<byte *>(output),
+                      reinterpret_cast<const byte *>(input), size);
+}
+
+std::string util::random_bytes(const std::size_t size) {
+  std::string result(size, '\0');
+  CryptoPP::AutoSeededRandomPool random;
+  random.GenerateBlock(reinterpret_cast<byte *>(result.data()), result.size());
+  return result;
+}
+
+std::string util::hash(const HashAlgorithm algorithm, const std::string &in) {
+  Hasher hasher(algorithm);
+  std::string result(hasher.digest_size(), '\0');
+  hasher.update(in).final(result.data());
+  return result;
+}
+
 std::string util::pbkdf2(const std::size_t key_size,
                          const std::string &start_key, const std::string &salt,
                          const std::size_t iteration_count) {
@@ -57,6 +220,34 @@ std::string util::pbkdf2(const std::size_t key_size,
   return result;
 }
 
+std::string util::cached_key(const std::string_view scheme,
+                             const std::string &salt,
+                             const std::uint64_t iteration_count,
+                             const std::string &secret,
+                             const std::function<std::string()> &derive,
+                             const std::function<bool(const std::string &)>
+                                 &verify) {
+  // the salt is prefixed with its size to keep the fields apart
+  std::string id(scheme);
+  id += '\0';
+  id += std::to_string(iteration_count);
+  id += '\0';
+  id += std::to_string(salt.size());
+  id += '\0';
+  id += salt;
+  id += secret_digest(secret);
+
+  if (const auto key = key_cache().find(id)) {
+    return *key;
+  }
+  std::string key = derive();
+  if (verify && !verify(key)) {
+    return key;
+  }
+  // every key counts once against the cache size
+  return *key_cache().insert(id, std::move(key), 1);
+}
+
 std::string util::decrypt_AES(const std::string &key,
                               const std::string &input) {
   std::string result(input.size(), '\0');
@@ -81,6 +272,25 @@ std::string util::decrypt_AES(const std::string &key, const std::string &iv,
   return result;
 }
 
+void util::decrypt_AES(const std::string &key, const char *input,
+                       char *output, const std::size_t size) {
+  CryptoPP::ECB_Mode<CryptoPP::AES>::Decryption decryption;
+  decryption.SetKey(reinterpret_cast<const byte *>(key.data()), key.size());
+  decryption.ProcessData(reinterpret_cast<byte *>(output),
+                         reinterpret_cast<const byte *>(input), size);
+}
+
+void util::decrypt_AES(const std::string &key, const std::string &iv,
+                       const char *input, char *output,
+                       const std::size_t size) {
+  CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption decryption;
+  decryption.SetKeyWithIV(reinterpret_cast<const byte *>(key.data()),
+                          key.size(), reinterpret_cast<const byte *>(iv.data()),
+                          iv.size());
+  decryption.ProcessData(reinterpret_cast<byte *>(output),
+                         reinterpret_cast<const byte *>(input), size);
+}
+
 std::string util::decrypt_TripleDES(const std::string &key,
                                     const std::string &iv,
                                     const std::string &input) {
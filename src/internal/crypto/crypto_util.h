@@ -1,18 +1,118 @@
 #ifndef ODR_INTERNAL_CRYPTO_UTIL_H
 #define ODR_INTERNAL_CRYPTO_UTIL_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+
+namespace CryptoPP {
+class HashTransformation;
+class SymmetricCipher;
+} // namespace CryptoPP
 
 namespace odr::internal::crypto::util {
+enum class HashAlgorithm {
+  SHA1,
+  SHA256,
+  SHA384,
+  SHA512,
+};
+
+// largest digest of the supported hash algorithms
+constexpr std::size_t max_digest_size = 64;
+
+// incremental hash which can be reused after `final` without allocating;
+// meant for iterated key derivation
+class Hasher final {
+public:
+  explicit Hasher(HashAlgorithm);
+  Hasher(Hasher &&) noexcept;
+  ~Hasher();
+  Hasher &operator=(Hasher &&) noexcept;
+
+  [[nodiscard]] std::size_t digest_size() const noexcept;
+
+  Hasher &update(const void *data, std::size_t size);
+  Hasher &update(std::string_view data);
+  // writes the digest to `digest` and restarts; `digest` may overlap with
+  // the previous input
+  void final(void *digest);
+
+private:
+  std::unique_ptr<CryptoPP::HashTransformation> m_impl;
+};
+
+enum class CipherAlgorithm {
+  AES_CBC,
+  TRIPLE_DES_CBC,
+  BLOWFISH_CFB,
+};
+
+// incremental decryption; the chaining state carries over from one call of
+// `process` to the next
+class Decryptor final {
+public:
+  Decryptor(CipherAlgorithm, const std::string &key, const std::string &iv);
+  Decryptor(Decryptor &&) noexcept;
+  ~Decryptor();
+  Decryptor &operator=(Decryptor &&) noexcept;
+
+  // `size` has to be a multiple of the block size except for the last call;
+  // `input` and `output` may be the same
+  void process(const char *input, char *output, std::size_t size);
+
+private:
+  std::unique_ptr<CryptoPP::SymmetricCipher> m_impl;
+};
+
+// counterpart of `Decryptor`; only block ciphers are supported
+class Encryptor final {
+public:
+  Encryptor(CipherAlgorithm, const std::string &key, const std::string &iv);
+  Encryptor(Encryptor &&) noexcept;
+  ~Encryptor();
+  Encryptor &operator=(Encryptor &&) noexcept;
+
+  // `size` has to be a multiple of the block size; `input` and `output` may
+  // be the same
+  void process(const char *input, char *output, std::size_t size);
+
+private:
+  std::unique_ptr<CryptoPP::SymmetricCipher> m_impl;
+};
+
+// cryptographically secure
+std::string random_bytes(std::size_t size);
 std::string base64_encode(const std::string &in);
 std::string base64_decode(const std::string &in);
 std::string sha1(const std::string &);
 std::string sha256(const std::string &);
+std::string sha384(const std::string &);
+std::string sha512(const std::string &);
+std::string hash(HashAlgorithm, const std::string &);
 std::string pbkdf2(std::size_t key_size, const std::string &start_key,
                    const std::string &salt, std::size_t iteration_count);
+// derived keys are remembered process wide so that reopening a document
+// skips the key derivation. the entries are identified by `scheme`, `salt`,
+// `iteration_count` and a keyed digest of `secret`; `derive` is called on a
+// miss. if given, only keys accepted by `verify` are remembered so that wrong
+// passwords do not evict the right ones
+std::string
+cached_key(std::string_view scheme, const std::string &salt,
+           std::uint64_t iteration_count, const std::string &secret,
+           const std::function<std::string()> &derive,
+           const std::function<bool(const std::string &)> &verify = {});
 std::string decrypt_AES(const std::string &key, const std::string &input);
 std::string decrypt_AES(const std::string &key, const std::string &iv,
                         const std::string &input);
+// in place friendly variants; `size` has to be a multiple of the block size
+void decrypt_AES(const std::string &key, const char *input, char *output,
+                 std::size_t size);
+void decrypt_AES(const std::string &key, const std::string &iv,
+                 const char *input, char *output, std::size_t size);
 std::string decrypt_TripleDES(const std::string &key, const std::string &iv,
                               const std::string &input);
 std::string decrypt_Blowfish(const std::string &key, const std::string &iv,
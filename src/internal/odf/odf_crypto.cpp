@@ -1,11 +1,22 @@
+#include <algorithm>
 #include <internal/abstract/file.h>
 #include <internal/abstract/filesystem.h>
 #include <internal/common/file.h>
+#include <internal/common/lru_cache.h>
+#include <internal/common/spill_file.h>
 #include <internal/crypto/crypto_util.h>
 #include <internal/odf/odf_crypto.h>
 #include <internal/util/stream_util.h>
+#include <internal/util/thread_util.h>
+#include <miniz.h>
+#include <new>
 #include <odr/exceptions.h>
+#include <odr/file_location.h>
+#include <istream>
 #include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
 
 namespace odr::internal::odf {
 
@@ -57,13 +68,133 @@ std::string start_key(const Manifest::Entry &entry,
   return result.substr(0, entry.start_key_size);
 }
 
+std::string derive_key(const Manifest::Entry &entry,
+                       const std::string &start_key,
+                       const std::function<bool(const std::string &)> &verify) {
+  return crypto::util::cached_key(
+      "PBKDF2/" + std::to_string(entry.key_size), entry.key_salt,
+      entry.key_iteration_count, start_key,
+      [&] {
+        return crypto::util::pbkdf2(entry.key_size, start_key, entry.key_salt,
+                                    entry.key_iteration_count);
+      },
+      verify);
+}
+
 std::string derive_key_and_decrypt(const Manifest::Entry &entry,
                                    const std::string &start_key,
                                    const std::string &input) {
-  const std::string derivedKey = crypto::util::pbkdf2(
-      entry.key_size, start_key, entry.key_salt, entry.key_iteration_count);
-  return decrypt(input, derivedKey, entry.initialisation_vector,
-                 entry.algorithm);
+  return decrypt(input, derive_key(entry, start_key),
+                 entry.initialisation_vector, entry.algorithm);
+}
+
+namespace {
+// multiple of the cipher block sizes
+constexpr std::size_t chunk_size = 16 * 1024;
+
+// what LibreOffice writes
+constexpr std::size_t encryption_key_size = 32;
+constexpr std::size_t encryption_iteration_count = 100000;
+constexpr std::size_t encryption_salt_size = 16;
+constexpr std::size_t encryption_iv_size = 16;
+constexpr std::size_t aes_block_size = 16;
+// of `ChecksumType::SHA1_1K` and `SHA256_1K`
+constexpr std::size_t checksum_size = 1024;
+
+class Deflater final {
+public:
+  Deflater() {
+    if (mz_deflateInit2(&m_stream, MZ_DEFAULT_LEVEL, MZ_DEFLATED,
+                        -MZ_DEFAULT_WINDOW_BITS, 9,
+                        MZ_DEFAULT_STRATEGY) != MZ_OK) {
+      throw std::bad_alloc();
+    }
+  }
+  Deflater(const Deflater &) = delete;
+  ~Deflater() { mz_deflateEnd(&m_stream); }
+  Deflater &operator=(const Deflater &) = delete;
+
+  // appends the deflated `input` to `output`
+  void deflate(const char *input, const std::size_t size, const bool finish,
+               std::string &output) {
+    m_stream.next_in = reinterpret_cast<const unsigned char *>(input);
+    m_stream.avail_in = static_cast<unsigned int>(size);
+    while (true) {
+      const std::size_t offset = output.size();
+      output.resize(offset + chunk_size);
+      m_stream.next_out = reinterpret_cast<unsigned char *>(&output[offset]);
+      m_stream.avail_out = chunk_size;
+      const int status =
+          mz_deflate(&m_stream, finish ? MZ_FINISH : MZ_NO_FLUSH);
+      output.resize(offset + chunk_size - m_stream.avail_out);
+      if ((status != MZ_OK) && (status != MZ_STREAM_END) &&
+          (status != MZ_BUF_ERROR)) {
+        throw std::runtime_error("deflate");
+      }
+      if (finish ? (status == MZ_STREAM_END) : (m_stream.avail_out != 0)) {
+        break;
+      }
+    }
+  }
+
+private:
+  mz_stream m_stream{};
+};
+} // namespace
+
+std::string encrypt(std::istream &input, const std::string &start_key,
+                    Manifest::Entry &entry) {
+  entry.size = 0;
+  entry.checksum_type = ChecksumType::SHA256_1K;
+  entry.algorithm = AlgorithmType::AES256_CBC;
+  entry.initialisation_vector =
+      crypto::util::random_bytes(encryption_iv_size);
+  entry.key_derivation = KeyDerivationType::PBKDF2;
+  entry.key_size = encryption_key_size;
+  entry.key_iteration_count = encryption_iteration_count;
+  entry.key_salt = crypto::util::random_bytes(encryption_salt_size);
+  entry.start_key_generation = ChecksumType::SHA256;
+  entry.start_key_size = start_key.size();
+
+  // the salt is fresh so there is no point in caching the key
+  const std::string derived_key =
+      crypto::util::pbkdf2(entry.key_size, start_key, entry.key_salt,
+                           entry.key_iteration_count);
+  crypto::util::Encryptor encryptor(crypto::util::CipherAlgorithm::AES_CBC,
+                                    derived_key, entry.initialisation_vector);
+  Deflater deflater;
+
+  // deflated and encrypted in place; the head stays plain until the checksum
+  // is known
+  std::string result;
+  std::size_t encrypted = 0;
+  char buffer[chunk_size];
+  bool finish = false;
+  while (!finish) {
+    input.read(buffer, chunk_size);
+    const auto length = static_cast<std::size_t>(input.gcount());
+    finish = !input;
+    entry.size += length;
+    deflater.deflate(buffer, length, finish, result);
+
+    if (entry.checksum.empty() && (finish || result.size() >= checksum_size)) {
+      entry.checksum = crypto::util::sha256(result.substr(0, checksum_size));
+    }
+    if (entry.checksum.empty()) {
+      continue;
+    }
+    if (finish) {
+      // W3C padding; the last byte tells the length
+      const std::size_t padding =
+          aes_block_size - result.size() % aes_block_size;
+      result.append(padding, static_cast<char>(padding));
+    }
+    const std::size_t end = result.size() - result.size() % aes_block_size;
+    encryptor.process(&result[encrypted], &result[encrypted], end - encrypted);
+    encrypted = end;
+  }
+
+  return result;
 }
 
 bool validate_password(const Manifest::Entry &entry,
@@ -79,12 +210,161 @@ bool validate_password(const Manifest::Entry &entry,
 }
 
 namespace {
+crypto::util::CipherAlgorithm cipher_algorithm(const AlgorithmType algorithm) {
+  switch (algorithm) {
+  case AlgorithmType::AES256_CBC:
+    return crypto::util::CipherAlgorithm::AES_CBC;
+  case AlgorithmType::TRIPLE_DES_CBC:
+    return crypto::util::CipherAlgorithm::TRIPLE_DES_CBC;
+  case AlgorithmType::BLOWFISH_CFB:
+    return crypto::util::CipherAlgorithm::BLOWFISH_CFB;
+  default:
+    throw std::invalid_argument("algorithm");
+  }
+}
+
+// decrypts the encrypted `source` chunk by chunk
+class DecryptingBuffer final : public std::streambuf {
+public:
+  DecryptingBuffer(std::unique_ptr<std::istream> source,
+                   crypto::util::Decryptor decryptor)
+      : m_source{std::move(source)}, m_decryptor{std::move(decryptor)} {}
+
+protected:
+  int_type underflow() final {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    m_source->read(m_buffer, sizeof(m_buffer));
+    const auto length = static_cast<std::size_t>(m_source->gcount());
+    if (length == 0) {
+      return traits_type::eof();
+    }
+    m_decryptor.process(m_buffer, m_buffer, length);
+    setg(m_buffer, m_buffer, m_buffer + length);
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  std::unique_ptr<std::istream> m_source;
+  crypto::util::Decryptor m_decryptor;
+  char m_buffer[chunk_size];
+};
+
+// inflates the raw deflate stream of `source`; the padding of the cipher
+// behind the end of the stream is ignored
+class InflatingBuffer final : public std::streambuf {
+public:
+  explicit InflatingBuffer(std::unique_ptr<std::streambuf> source)
+      : m_source{std::move(source)} {
+    if (mz_inflateInit2(&m_stream, -MZ_DEFAULT_WINDOW_BITS) != MZ_OK) {
+      throw std::bad_alloc();
+    }
+  }
+  InflatingBuffer(const InflatingBuffer &) = delete;
+  ~InflatingBuffer() final { mz_inflateEnd(&m_stream); }
+  InflatingBuffer &operator=(const InflatingBuffer &) = delete;
+
+protected:
+  int_type underflow() final {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    while (!m_end) {
+      if (m_stream.avail_in == 0) {
+        const std::streamsize length = m_source->sgetn(m_input, chunk_size);
+        if (length <= 0) {
+          // truncated
+          throw FileReadError();
+        }
+        m_stream.next_in = reinterpret_cast<const unsigned char *>(m_input);
+        m_stream.avail_in = static_cast<unsigned int>(length);
+      }
+
+      m_stream.next_out = reinterpret_cast<unsigned char *>(m_output);
+      m_stream.avail_out = chunk_size;
+      const int status = mz_inflate(&m_stream, MZ_NO_FLUSH);
+      if (status == MZ_STREAM_END) {
+        m_end = true;
+      } else if ((status != MZ_OK) && (status != MZ_BUF_ERROR)) {
+        throw FileReadError();
+      }
+
+      const std::size_t length = chunk_size - m_stream.avail_out;
+      if (length > 0) {
+        setg(m_output, m_output, m_output + length);
+        return traits_type::to_int_type(*gptr());
+      }
+    }
+    return traits_type::eof();
+  }
+
+private:
+  std::unique_ptr<std::streambuf> m_source;
+  mz_stream m_stream{};
+  bool m_end{false};
+  char m_input[chunk_size];
+  char m_output[chunk_size];
+};
+
+class DecryptedIstream final : public std::istream {
+public:
+  explicit DecryptedIstream(std::unique_ptr<std::streambuf> sbuf)
+      : std::istream(sbuf.get()), m_sbuf{std::move(sbuf)} {}
+
+private:
+  std::unique_ptr<std::streambuf> m_sbuf;
+};
+
+// decrypts and inflates while it is read
+class DecryptedFile final : public abstract::File {
+public:
+  DecryptedFile(std::shared_ptr<abstract::File> encrypted,
+                const Manifest::Entry &entry, std::string derived_key)
+      : m_encrypted{std::move(encrypted)}, m_entry{entry},
+        m_derived_key{std::move(derived_key)} {}
+
+  [[nodiscard]] FileLocation location() const noexcept final {
+    return FileLocation::MEMORY;
+  }
+
+  [[nodiscard]] std::size_t size() const final { return m_entry.size; }
+
+  [[nodiscard]] std::unique_ptr<std::istream> read() const final {
+    crypto::util::Decryptor decryptor(cipher_algorithm(m_entry.algorithm),
+                                      m_derived_key,
+                                      m_entry.initialisation_vector);
+    auto decrypting = std::make_unique<DecryptingBuffer>(
+        m_encrypted->read(), std::move(decryptor));
+    return std::make_unique<DecryptedIstream>(
+        std::make_unique<InflatingBuffer>(std::move(decrypting)));
+  }
+
+private:
+  const std::shared_ptr<abstract::File> m_encrypted;
+  const Manifest::Entry m_entry;
+  const std::string m_derived_key;
+};
+
+// parts up to this size are decrypted once and kept, in memory as long as the
+// document budget allows; bigger ones are streamed on every open
+constexpr std::size_t cached_part_size = 4 * 1024 * 1024;
+constexpr std::size_t part_cache_budget = 32 * 1024 * 1024;
+
+// the manifest lists the parts relative to the root
+bool needed_for_translation(const common::Path &path) {
+  const std::string &string = path.string();
+  return (string == "content.xml") || (string == "styles.xml") ||
+         (string == "meta.xml") || (string.rfind("Pictures/", 0) == 0);
+}
+
 class DecryptedFilesystem final : public abstract::ReadableFilesystem {
 public:
   DecryptedFilesystem(std::shared_ptr<abstract::ReadableFilesystem> parent,
-                      Manifest manifest, std::string start_key)
+                      Manifest manifest, std::string start_key,
+                      std::shared_ptr<common::MemoryBudget> budget)
       : m_parent(std::move(parent)), m_manifest(std::move(manifest)),
-        m_start_key(std::move(start_key)) {}
+        m_start_key(std::move(start_key)), m_budget(std::move(budget)) {}
 
   [[nodiscard]] bool exists(common::Path p) const final {
     return m_parent->exists(std::move(p));
@@ -112,41 +392,137 @@ public:
     if (!can_decrypt(it->second)) {
       throw UnsupportedCryptoAlgorithm();
     }
-    // TODO stream
-    auto source = m_parent->open(path)->read();
-    const std::string input = util::stream::read(*source);
-    std::string result = crypto::util::inflate(
-        derive_key_and_decrypt(it->second, m_start_key, input));
-    return std::make_shared<common::MemoryFile>(result);
+
+    if (const auto cached = m_cache.find(path)) {
+      return *cached;
+    }
+    auto file = std::make_shared<DecryptedFile>(
+        m_parent->open(path), it->second,
+        derive_key(it->second, m_start_key));
+    if (it->second.size > cached_part_size) {
+      return file;
+    }
+    // checks the decrypted size against the manifest
+    auto spill_file = std::make_shared<common::SpillFile>(*file, m_budget);
+    const std::size_t cost = spill_file->size();
+    return *m_cache.insert(path, std::move(spill_file), cost);
+  }
+
+  // decrypts the parts needed for translation into the cache on up to
+  // `concurrency` threads
+  void prefetch(const std::size_t concurrency) const {
+    std::vector<const common::Path *> paths;
+    std::size_t size = 0;
+    for (auto &&[path, entry] : m_manifest.entries) {
+      if (!can_decrypt(entry) || (entry.size > cached_part_size) ||
+          (size + entry.size > part_cache_budget) ||
+          !needed_for_translation(path)) {
+        continue;
+      }
+      paths.push_back(&path);
+      size += entry.size;
+    }
+
+    util::thread::parallel_for(
+        paths.size(), concurrency,
+        [&](const std::size_t index) {
+          try {
+            static_cast<void>(open(*paths[index]));
+          } catch (...) {
+            // reported once the part is opened for translation
+          }
+        });
   }
 
 private:
   const std::shared_ptr<abstract::ReadableFilesystem> m_parent;
   const Manifest m_manifest;
   const std::string m_start_key;
+  const std::shared_ptr<common::MemoryBudget> m_budget;
+  mutable common::LruCache<common::Path, std::shared_ptr<common::SpillFile>>
+      m_cache{part_cache_budget};
 };
 } // namespace
 
+namespace {
+// largest padding of the supported ciphers
+constexpr std::size_t max_padding = 16;
+} // namespace
+
+PasswordVerifier::PasswordVerifier(
+    const abstract::ReadableFilesystem &filesystem, const Manifest &manifest)
+    : m_entry{*manifest.smallest_file_entry} {
+  if (!can_decrypt(m_entry)) {
+    throw UnsupportedCryptoAlgorithm();
+  }
+
+  const auto file = filesystem.open(*manifest.smallest_file_path);
+  const auto in = file->read();
+  // the head is only enough if the padding cannot reach into it
+  m_head = ((m_entry.checksum_type == ChecksumType::SHA1_1K) ||
+            (m_entry.checksum_type == ChecksumType::SHA256_1K)) &&
+           (file->size() >= checksum_size + max_padding);
+  if (m_head) {
+    m_input.resize(checksum_size);
+    in->read(m_input.data(), m_input.size());
+    if (static_cast<std::size_t>(in->gcount()) != m_input.size()) {
+      throw FileReadError();
+    }
+  } else {
+    m_input = util::stream::read(*in);
+  }
+}
+
+bool PasswordVerifier::verify(const std::string &password) const {
+  std::optional<bool> verdict;
+  const auto check = [&](const std::string &derived_key) {
+    const std::string decrypted = decrypt(
+        m_input, derived_key, m_entry.initialisation_vector, m_entry.algorithm);
+    if (m_head) {
+      verdict = hash(decrypted, m_entry.checksum_type) == m_entry.checksum;
+    } else {
+      verdict = validate_password(m_entry, decrypted);
+    }
+    return *verdict;
+  };
+  // wrong passwords are not remembered; `check` already ran on a cache miss
+  const std::string derived_key =
+      derive_key(m_entry, start_key(m_entry, password), check);
+  return verdict ? *verdict : check(derived_key);
+}
+
+std::optional<std::size_t>
+PasswordVerifier::verify(const std::vector<std::string> &passwords) const {
+  std::vector<char> valid(passwords.size(), false);
+  util::thread::parallel_for(
+      passwords.size(), util::thread::default_concurrency(),
+      [&](const std::size_t i) { valid[i] = verify(passwords[i]); });
+
+  const auto it = std::find(std::begin(valid), std::end(valid), true);
+  if (it == std::end(valid)) {
+    return {};
+  }
+  return it - std::begin(valid);
+}
+
 bool decrypt(std::shared_ptr<abstract::ReadableFilesystem> &storage,
-             const Manifest &manifest, const std::string &password) {
+             const Manifest &manifest, const std::string &password,
+             std::shared_ptr<common::MemoryBudget> budget,
+             const std::size_t concurrency) {
   if (!manifest.encrypted) {
     return true;
   }
-  if (!can_decrypt(*manifest.smallest_file_entry)) {
-    throw UnsupportedCryptoAlgorithm();
+  if (!PasswordVerifier(*storage, manifest).verify(password)) {
+    return false;
   }
   const std::string start_key =
       odf::start_key(*manifest.smallest_file_entry, password);
-  // TODO stream decrypt
-  const std::string input =
-      util::stream::read(*storage->open(*manifest.smallest_file_path)->read());
-  const std::string decrypt =
-      derive_key_and_decrypt(*manifest.smallest_file_entry, start_key, input);
-  if (!validate_password(*manifest.smallest_file_entry, decrypt)) {
-    return false;
+  auto decrypted = std::make_shared<DecryptedFilesystem>(
+      std::move(storage), manifest, start_key, std::move(budget));
+  if (concurrency > 0) {
+    decrypted->prefetch(concurrency);
   }
-  storage = std::make_shared<DecryptedFilesystem>(std::move(storage), manifest,
-                                                  start_key);
+  storage = std::move(decrypted);
   return true;
 }
 
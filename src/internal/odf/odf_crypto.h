@@ -1,16 +1,25 @@
 #ifndef ODR_INTERNAL_ODF_CRYPTO_H
 #define ODR_INTERNAL_ODF_CRYPTO_H
 
+#include <cstddef>
 #include <exception>
+#include <functional>
 #include <internal/odf/odf_manifest.h>
 #include <internal/odf/odf_meta.h>
+#include <iosfwd>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace odr::internal::abstract {
 class ReadableFilesystem;
 } // namespace odr::internal::abstract
 
+namespace odr::internal::common {
+class MemoryBudget;
+} // namespace odr::internal::common
+
 namespace odr::internal::odf {
 
 bool can_decrypt(const Manifest::Entry &) noexcept;
@@ -23,14 +32,47 @@ std::string decrypt(const std::string &input, const std::string &derived_key,
 
 std::string start_key(const Manifest::Entry &, const std::string &password);
 
+// the key is only remembered for later documents if `verify` accepts it
+std::string derive_key(const Manifest::Entry &, const std::string &start_key,
+                       const std::function<bool(const std::string &)> &verify =
+                           {});
+
 std::string derive_key_and_decrypt(const Manifest::Entry &,
                                    const std::string &start_key,
                                    const std::string &input);
 
+// deflates and encrypts `input` with a fresh salt and initialisation vector
+// which are written to `entry` together with the checksum and the size
+std::string encrypt(std::istream &input, const std::string &start_key,
+                    Manifest::Entry &entry);
+
 bool validate_password(const Manifest::Entry &, std::string decrypted) noexcept;
 
+// checks passwords against the smallest encrypted file which is read once.
+// with a checksum over the first KiB only that much is read and decrypted
+class PasswordVerifier final {
+public:
+  PasswordVerifier(const abstract::ReadableFilesystem &, const Manifest &);
+
+  [[nodiscard]] bool verify(const std::string &password) const;
+  // index of the first matching password; they are checked in parallel
+  [[nodiscard]] std::optional<std::size_t>
+  verify(const std::vector<std::string> &passwords) const;
+
+private:
+  Manifest::Entry m_entry;
+  // the encrypted file or its head
+  std::string m_input;
+  bool m_head{false};
+};
+
+// decrypted parts are kept within `budget`. with a `concurrency` above zero
+// the parts needed for translation are decrypted right away on that many
+// threads instead of on first access
 bool decrypt(std::shared_ptr<abstract::ReadableFilesystem> &, const Manifest &,
-             const std::string &password);
+             const std::string &password,
+             std::shared_ptr<common::MemoryBudget> budget,
+             std::size_t concurrency = 0);
 
 } // namespace odr::internal::odf
 
@@ -2,6 +2,9 @@
 #include <internal/odf/odf_manifest.h>
 #include <internal/util/map_util.h>
 #include <pugixml.hpp>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
 
 namespace odr::internal::odf {
 
@@ -51,6 +54,80 @@ bool lookup_start_key_types(const std::string &checksum,
   return util::map::lookup_map_default(STARTKEY_TYPES, checksum, checksumType,
                                        ChecksumType::UNKNOWN);
 }
+
+const char *checksum_type_name(const ChecksumType checksum_type) {
+  switch (checksum_type) {
+  case ChecksumType::SHA1:
+    return "SHA1";
+  case ChecksumType::SHA1_1K:
+    return "SHA1/1K";
+  case ChecksumType::SHA256_1K:
+    return "urn:oasis:names:tc:opendocument:xmlns:manifest:1.0#sha256-1k";
+  default:
+    throw std::invalid_argument("checksum type");
+  }
+}
+
+const char *algorithm_type_name(const AlgorithmType algorithm_type) {
+  switch (algorithm_type) {
+  case AlgorithmType::AES256_CBC:
+    return "http://www.w3.org/2001/04/xmlenc#aes256-cbc";
+  case AlgorithmType::BLOWFISH_CFB:
+    return "Blowfish CFB";
+  default:
+    throw std::invalid_argument("algorithm type");
+  }
+}
+
+const char *start_key_type_name(const ChecksumType checksum_type) {
+  switch (checksum_type) {
+  case ChecksumType::SHA1:
+    return "SHA1";
+  case ChecksumType::SHA256:
+    return "http://www.w3.org/2000/09/xmldsig#sha256";
+  default:
+    throw std::invalid_argument("start key type");
+  }
+}
+
+void set_attribute(pugi::xml_node node, const char *name,
+                   const std::string &value) {
+  pugi::xml_attribute attribute = node.attribute(name);
+  if (!attribute) {
+    attribute = node.append_attribute(name);
+  }
+  attribute.set_value(value.c_str());
+}
+
+void write_entry(pugi::xml_node file_entry, const Manifest::Entry &entry) {
+  set_attribute(file_entry, "manifest:size", std::to_string(entry.size));
+
+  pugi::xml_node crypto = file_entry.append_child("manifest:encryption-data");
+  set_attribute(crypto, "manifest:checksum-type",
+                checksum_type_name(entry.checksum_type));
+  set_attribute(crypto, "manifest:checksum",
+                crypto::util::base64_encode(entry.checksum));
+
+  pugi::xml_node algorithm = crypto.append_child("manifest:algorithm");
+  set_attribute(algorithm, "manifest:algorithm-name",
+                algorithm_type_name(entry.algorithm));
+  set_attribute(algorithm, "manifest:initialisation-vector",
+                crypto::util::base64_encode(entry.initialisation_vector));
+
+  pugi::xml_node start = crypto.append_child("manifest:start-key-generation");
+  set_attribute(start, "manifest:start-key-generation-name",
+                start_key_type_name(entry.start_key_generation));
+  set_attribute(start, "manifest:key-size",
+                std::to_string(entry.start_key_size));
+
+  pugi::xml_node key = crypto.append_child("manifest:key-derivation");
+  set_attribute(key, "manifest:key-derivation-name", "PBKDF2");
+  set_attribute(key, "manifest:key-size", std::to_string(entry.key_size));
+  set_attribute(key, "manifest:iteration-count",
+                std::to_string(entry.key_iteration_count));
+  set_attribute(key, "manifest:salt",
+                crypto::util::base64_encode(entry.key_salt));
+}
 } // namespace
 
 Manifest parse_manifest(const pugi::xml_document &manifest) {
@@ -126,4 +203,34 @@ Manifest parse_manifest(const pugi::xml_document &manifest) {
   return result;
 }
 
+void write_encryption_data(
+    pugi::xml_document &manifest,
+    const std::unordered_map<common::Path, Manifest::Entry> &entries) {
+  pugi::xml_node root = manifest.child("manifest:manifest");
+  std::unordered_set<common::Path> written;
+
+  for (auto &&e : root.children()) {
+    while (const pugi::xml_node crypto = e.child("manifest:encryption-data")) {
+      e.remove_child(crypto);
+    }
+    const common::Path path = e.attribute("manifest:full-path").as_string();
+    const auto it = entries.find(path);
+    if (it == std::end(entries)) {
+      continue;
+    }
+    write_entry(e, it->second);
+    written.insert(path);
+  }
+
+  for (auto &&[path, entry] : entries) {
+    if (written.find(path) != std::end(written)) {
+      continue;
+    }
+    pugi::xml_node e = root.append_child("manifest:file-entry");
+    set_attribute(e, "manifest:full-path", path.string());
+    set_attribute(e, "manifest:media-type", "");
+    write_entry(e, entry);
+  }
+}
+
 } // namespace odr::internal::odf
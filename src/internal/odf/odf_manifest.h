@@ -42,6 +42,12 @@ struct Manifest {
 
 Manifest parse_manifest(const pugi::xml_document &manifest);
 
+// replaces the encryption data of the files in `manifest` by `entries`;
+// files which are not listed yet are added
+void write_encryption_data(
+    pugi::xml_document &manifest,
+    const std::unordered_map<common::Path, Manifest::Entry> &entries);
+
 } // namespace odr::internal::odf
 
 #endif // ODR_INTERNAL_ODF_MANIFEST_H
@@ -1,8 +1,13 @@
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <internal/abstract/filesystem.h>
 #include <internal/common/file.h>
 #include <internal/common/html.h>
+#include <internal/common/html_writer.h>
 #include <internal/common/path.h>
+#include <internal/common/resource_writer.h>
+#include <internal/crypto/crypto_util.h>
 #include <internal/odf/odf_crypto.h>
 #include <internal/odf/odf_manifest.h>
 #include <internal/odf/odf_meta.h>
@@ -11,19 +16,23 @@
 #include <internal/odf/odf_translator_context.h>
 #include <internal/odf/odf_translator_style.h>
 #include <internal/util/stream_util.h>
+#include <internal/util/thread_util.h>
 #include <internal/util/xml_util.h>
 #include <internal/zip/zip_archive.h>
 #include <nlohmann/json.hpp>
 #include <odr/exceptions.h>
 #include <odr/file_meta.h>
 #include <odr/html_config.h>
+#include <optional>
 #include <pugixml.hpp>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 namespace odr::internal::odf {
 
 namespace {
-void generate_style(std::ofstream &out, Context &context) {
+void generate_style(common::HtmlWriter &out, Context &context) {
   out << common::Html::default_style();
 
   if (context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET) {
@@ -71,33 +80,44 @@ void generate_content_style(const pugi::xml_node &in, Context &context) {
   }
 }
 
-void generate_script(std::ofstream &out, Context &) {
+void generate_script(common::HtmlWriter &out, Context &context) {
   out << common::Html::default_script();
-}
 
-void generate_content(const pugi::xml_node &in, Context &context) {
-  const pugi::xml_node body =
-      in.child("office:document-content").child("office:body");
+  if ((context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET) &&
+      context.config->table_virtualized && !context.config->editable) {
+    out << common::Html::virtual_table_script();
+  }
+}
 
+struct EntryContent {
   pugi::xml_node content;
-  std::string entry_name;
+  const char *entry_name;
+};
+
+EntryContent entry_content(const pugi::xml_node &body, const Context &context) {
   switch (context.meta->type) {
   case FileType::OPENDOCUMENT_TEXT:
   case FileType::OPENDOCUMENT_GRAPHICS:
-    content = body.child("office:drawing");
-    entry_name = "draw:page";
-    break;
+    return {body.child("office:drawing"), "draw:page"};
   case FileType::OPENDOCUMENT_PRESENTATION:
-    content = body.child("office:presentation");
-    entry_name = "draw:page";
-    break;
+    return {body.child("office:presentation"), "draw:page"};
   case FileType::OPENDOCUMENT_SPREADSHEET:
-    content = body.child("office:spreadsheet");
-    entry_name = "table:table";
-    break;
+    return {body.child("office:spreadsheet"), "table:table"};
   default:
     throw std::invalid_argument("type");
   }
+}
+
+bool entry_selected(const std::uint32_t entry, const HtmlConfig &config) {
+  return (entry >= config.entry_offset) &&
+         ((config.entry_count == 0) ||
+          (entry < config.entry_offset + config.entry_count));
+}
+
+void generate_content(const pugi::xml_node &in, Context &context) {
+  const pugi::xml_node body =
+      in.child("office:document-content").child("office:body");
+  const auto [content, entry_name] = entry_content(body, context);
 
   context.entry = 0;
 
@@ -105,12 +125,10 @@ void generate_content(const pugi::xml_node &in, Context &context) {
                   (context.config->entry_count > 0))) {
     std::uint32_t i = 0;
     for (auto &&e : content) {
-      if (e.name() != entry_name) {
+      if (std::strcmp(e.name(), entry_name) != 0) {
         continue;
       }
-      if ((i >= context.config->entry_offset) &&
-          ((context.config->entry_count == 0) ||
-           (i < context.config->entry_offset + context.config->entry_count))) {
+      if (entry_selected(i, *context.config)) {
         content_translator::html(e, context);
       } else {
         ++context.entry; // TODO hacky
@@ -121,11 +139,113 @@ void generate_content(const pugi::xml_node &in, Context &context) {
     content_translator::html(body, context);
   }
 }
+
+struct Entry {
+  std::uint32_t index;
+  pugi::xml_node node;
+};
+
+void generate_entry(const Entry &entry, const common::Path &directory,
+                    Context &context) {
+  std::ofstream ostream(
+      directory.join("entry-" + std::to_string(entry.index) + ".html").path());
+  if (!ostream.is_open()) {
+    throw FileNotCreated();
+  }
+  common::HtmlWriter out(ostream);
+
+  context.output = &out;
+  context.entry = entry.index;
+
+  out << common::Html::doctype();
+  out << "<html><head>";
+  out << common::Html::default_headers();
+  out << R"(<link rel="stylesheet" href="style.css"/>)";
+  out << "</head>";
+
+  out << "<body " << common::Html::body_attributes(*context.config) << ">";
+  content_translator::html(entry.node, context);
+  out << "</body>";
+
+  out << R"(<script src="script.js"></script>)";
+  out << "</html>";
+
+  context.output = nullptr;
+  out.flush();
+}
+
+// one file per entry next to the shared `style.css` and `script.js`
+void generate_entries(const pugi::xml_node &in, const common::Path &directory,
+                      Context &context) {
+  std::filesystem::create_directories(directory.path());
+
+  {
+    std::ofstream ostream(directory.join("style.css").path());
+    if (!ostream.is_open()) {
+      throw FileNotCreated();
+    }
+    common::HtmlWriter out(ostream);
+    context.output = &out;
+    generate_style(out, context);
+    generate_content_style(in, context);
+    context.style_classes =
+        common::Html::style_classes(context.style_dependencies);
+    context.output = nullptr;
+    out.flush();
+  }
+
+  {
+    std::ofstream ostream(directory.join("script.js").path());
+    if (!ostream.is_open()) {
+      throw FileNotCreated();
+    }
+    common::HtmlWriter out(ostream);
+    generate_script(out, context);
+    out.flush();
+  }
+
+  const pugi::xml_node body =
+      in.child("office:document-content").child("office:body");
+  const auto [content, entry_name] = entry_content(body, context);
+
+  std::vector<Entry> entries;
+  std::uint32_t i = 0;
+  for (auto &&e : content) {
+    if (std::strcmp(e.name(), entry_name) != 0) {
+      continue;
+    }
+    if (entry_selected(i, *context.config)) {
+      entries.push_back({i, e});
+    }
+    ++i;
+  }
+  if (i == 0) {
+    // text documents are one entry
+    entries.push_back({0, body});
+  }
+
+  if (context.config->editable) {
+    // text ids have to be unique across the entries
+    for (auto &&entry : entries) {
+      generate_entry(entry, directory, context);
+    }
+    return;
+  }
+
+  // the document is only read; every entry gets its own mutable state
+  util::thread::parallel_for(
+      entries.size(), util::thread::default_concurrency(),
+      [&](const std::size_t index) {
+        Context entry_context = context;
+        generate_entry(entries[index], directory, entry_context);
+      });
+}
 } // namespace
 
 OpenDocumentTranslator::OpenDocumentTranslator(
-    std::shared_ptr<abstract::ReadableFilesystem> filesystem)
-    : m_filesystem{std::move(filesystem)} {
+    std::shared_ptr<abstract::ReadableFilesystem> filesystem,
+    std::shared_ptr<common::MemoryBudget> budget)
+    : m_filesystem{std::move(filesystem)}, m_budget{std::move(budget)} {
   if (m_filesystem->exists("META-INF/manifest.xml")) {
     auto manifest = util::xml::parse(*m_filesystem, "META-INF/manifest.xml");
 
@@ -159,7 +279,7 @@ bool OpenDocumentTranslator::editable() const noexcept { return true; }
 
 bool OpenDocumentTranslator::savable(const bool encrypted) const noexcept {
   if (encrypted) {
-    return false;
+    return !m_meta.encrypted || m_decrypted;
   }
   return !m_meta.encrypted;
 }
@@ -167,7 +287,9 @@ bool OpenDocumentTranslator::savable(const bool encrypted) const noexcept {
 bool OpenDocumentTranslator::decrypt(const std::string &password) {
   // TODO throw if not encrypted
   // TODO throw if decrypted
-  const bool success = odf::decrypt(m_filesystem, m_manifest, password);
+  const bool success = odf::decrypt(m_filesystem, m_manifest, password,
+                                    m_budget,
+                                    util::thread::default_concurrency());
   if (success) {
     auto manifest = util::xml::parse(*m_filesystem, "META-INF/manifest.xml");
     m_meta = parse_file_meta(*m_filesystem, &manifest, true);
@@ -180,15 +302,41 @@ bool OpenDocumentTranslator::decrypt(const std::string &password) {
 void OpenDocumentTranslator::translate(const common::Path &path,
                                        const HtmlConfig &config) {
   // TODO throw if not decrypted
-  std::ofstream out(path.path());
-  if (!out.is_open()) {
+  // the entries of split output share the directory of the resources
+  std::optional<common::ResourceWriter> resources;
+  if (config.external_resources) {
+    const auto directory =
+        config.split_entries ? path.path() : path.path().parent_path();
+    resources.emplace(directory / config.external_resource_path,
+                      config.external_resource_path);
+  }
+
+  if (config.split_entries) {
+    m_context.config = &config;
+    m_context.meta = &m_meta;
+    m_context.filesystem = m_filesystem.get();
+    m_context.resources = resources ? &*resources : nullptr;
+
+    m_content = util::xml::parse(*m_filesystem, "content.xml");
+
+    generate_entries(m_content, path, m_context);
+
+    m_context.config = nullptr;
+    m_context.resources = nullptr;
+    return;
+  }
+
+  std::ofstream ostream(path.path());
+  if (!ostream.is_open()) {
     throw FileNotCreated();
   }
+  common::HtmlWriter out(ostream);
 
   m_context.config = &config;
   m_context.meta = &m_meta;
   m_context.filesystem = m_filesystem.get();
   m_context.output = &out;
+  m_context.resources = resources ? &*resources : nullptr;
 
   m_content = util::xml::parse(*m_filesystem, "content.xml");
 
@@ -198,6 +346,8 @@ void OpenDocumentTranslator::translate(const common::Path &path,
   out << "<style>";
   generate_style(out, m_context);
   generate_content_style(m_content, m_context);
+  m_context.style_classes =
+      common::Html::style_classes(m_context.style_dependencies);
   out << "</style>";
   out << "</head>";
 
@@ -212,7 +362,9 @@ void OpenDocumentTranslator::translate(const common::Path &path,
 
   m_context.config = nullptr;
   m_context.output = nullptr;
-  out.close();
+  m_context.resources = nullptr;
+  out.flush();
+  ostream.close();
 }
 
 void OpenDocumentTranslator::edit(const std::string &diff) {
@@ -270,7 +422,64 @@ void OpenDocumentTranslator::save(const common::Path &path) const {
 void OpenDocumentTranslator::save(const common::Path &path,
                                   const std::string &password) const {
   // TODO throw if not decrypted
-  throw UnsupportedOperation();
+  zip::ZipArchive archive;
+
+  // `mimetype` has to be the first file and uncompressed
+  if (m_filesystem->is_file("mimetype")) {
+    archive.insert_file(std::end(archive), "mimetype",
+                        m_filesystem->open("mimetype"), 0);
+  }
+
+  std::vector<common::Path> files;
+  for (auto walker = m_filesystem->file_walker("/"); !walker->end();
+       walker->next()) {
+    auto p = walker->path();
+    if ((p == "mimetype") || (p == "META-INF/manifest.xml")) {
+      continue;
+    }
+    if (m_filesystem->is_directory(p)) {
+      archive.insert_directory(std::end(archive), p);
+      continue;
+    }
+    files.push_back(std::move(p));
+  }
+
+  // the files are independent of each other; each one gets its own salt
+  const std::string start_key = crypto::util::sha256(password);
+  std::vector<std::shared_ptr<common::MemoryFile>> encrypted(files.size());
+  std::vector<Manifest::Entry> entries(files.size());
+  util::thread::parallel_for(
+      files.size(), util::thread::default_concurrency(),
+      [&](const std::size_t i) {
+        std::unique_ptr<std::istream> in;
+        if (files[i] == "content.xml") {
+          auto out = std::make_unique<std::stringstream>();
+          m_content.print(*out);
+          in = std::move(out);
+        } else {
+          in = m_filesystem->open(files[i])->read();
+        }
+        encrypted[i] = std::make_shared<common::MemoryFile>(
+            odf::encrypt(*in, start_key, entries[i]));
+      });
+
+  std::unordered_map<common::Path, Manifest::Entry> manifest_entries;
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    // deflated already
+    archive.insert_file(std::end(archive), files[i], encrypted[i], 0);
+    manifest_entries.emplace(files[i], std::move(entries[i]));
+  }
+
+  auto manifest = util::xml::parse(*m_filesystem, "META-INF/manifest.xml");
+  write_encryption_data(manifest, manifest_entries);
+  std::stringstream manifest_out;
+  manifest.print(manifest_out);
+  archive.insert_file(
+      std::end(archive), "META-INF/manifest.xml",
+      std::make_shared<common::MemoryFile>(manifest_out.str()));
+
+  std::ofstream ostream(path.path());
+  archive.save(ostream);
 }
 
 } // namespace odr::internal::odf
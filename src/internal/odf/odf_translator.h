@@ -14,14 +14,17 @@ class ReadableFilesystem;
 
 namespace odr::internal::common {
 class Path;
-}
+class MemoryBudget;
+} // namespace odr::internal::common
 
 namespace odr::internal::odf {
 
 class OpenDocumentTranslator final : public abstract::DocumentTranslator {
 public:
-  explicit OpenDocumentTranslator(
-      std::shared_ptr<abstract::ReadableFilesystem> filesystem);
+  // intermediate buffers of the document are kept within `budget`
+  OpenDocumentTranslator(
+      std::shared_ptr<abstract::ReadableFilesystem> filesystem,
+      std::shared_ptr<common::MemoryBudget> budget);
   OpenDocumentTranslator(const OpenDocumentTranslator &) = delete;
   OpenDocumentTranslator(OpenDocumentTranslator &&) noexcept;
   ~OpenDocumentTranslator() final;
@@ -47,6 +50,7 @@ public:
 
 private:
   std::shared_ptr<abstract::ReadableFilesystem> m_filesystem;
+  std::shared_ptr<common::MemoryBudget> m_budget;
 
   FileMeta m_meta;
   Manifest m_manifest;
@@ -1,110 +1,153 @@
+#include <array>
 #include <cstring>
 #include <glog/logging.h>
+#include <internal/abstract/file.h>
 #include <internal/abstract/filesystem.h>
-#include <internal/common/file.h>
+#include <internal/common/html_writer.h>
 #include <internal/common/path.h>
-#include <internal/crypto/crypto_util.h>
+#include <internal/common/table_data.h>
 #include <internal/odf/odf_translator_content.h>
 #include <internal/odf/odf_translator_context.h>
 #include <internal/odf/odf_translator_style.h>
-#include <internal/svm/svm_file.h>
 #include <internal/svm/svm_to_svg.h>
+#include <internal/util/element_util.h>
+#include <internal/util/map_util.h>
 #include <internal/util/stream_util.h>
-#include <internal/util/string_util.h>
+#include <internal/util/xml_util.h>
 #include <odr/file_meta.h>
 #include <odr/html_config.h>
 #include <pugixml.hpp>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace odr::internal::odf {
 
 namespace {
-void text_translator(const pugi::xml_text &in, std::ostream &out,
+void text_translator(const pugi::xml_text &in, common::HtmlWriter &out,
                      Context &context) {
-  std::string text = in.as_string();
-  util::string::replace_all(text, "&", "&amp;");
-  util::string::replace_all(text, "<", "&lt;");
-  util::string::replace_all(text, ">", "&gt;");
-
   if (!context.config->editable) {
-    out << text;
+    out.write_escaped(in.as_string());
   } else {
     out << R"(<span contenteditable="true" data-odr-cid=")"
-        << context.current_text_translation_index << "\">" << text << "</span>";
+        << context.current_text_translation_index << "\">";
+    out.write_escaped(in.as_string());
+    out << "</span>";
     context.text_translation[context.current_text_translation_index] = in;
     ++context.current_text_translation_index;
   }
 }
 
-void style_class_translator(const std::string &name, std::ostream &out,
-                            Context &context) {
-  out << name;
+// interned class attribute value of a style; see `Context::style_classes`
+const std::string &style_class(const char *name, const bool master,
+                               Context &context) {
+  // reused to avoid an allocation per styled element
+  static thread_local std::string key;
+  key.clear();
+  if (master) {
+    key += "master_";
+  }
+  style_translator::escape_style_name(name, key);
 
-  { // handle style dependencies
-    const auto it = context.style_dependencies.find(name);
-    if (it == std::end(context.style_dependencies)) {
-      // TODO remove ?
-      LOG(WARNING) << "unknown style: " << name;
-    } else {
-      for (auto i = it->second.rbegin(); i != it->second.rend(); ++i) {
-        out << " " << *i;
-      }
-    }
+  auto it = context.style_classes.find(key);
+  if (it == std::end(context.style_classes)) {
+    // TODO remove ?
+    DLOG(WARNING) << "unknown style: " << key;
+    it = context.style_classes.emplace(key, key).first;
   }
+  return it->second;
 }
 
-void style_class_translator(const pugi::xml_node &in, std::ostream &out,
-                            Context &context) {
-  static std::unordered_set<std::string> style_attributes{
-      "text:style-name",         "table:style-name",
-      "draw:style-name",         "draw:text-style-name",
-      "presentation:style-name", "draw:master-page-name",
-  };
+enum class StyleAttribute {
+  VALUE_TYPE,
+  STYLE,
+  TABLE_STYLE,
+  MASTER_PAGE,
+};
+
+// sorted by attribute name
+constexpr util::map::StaticEntry<StyleAttribute> style_attributes[]{
+    {"draw:master-page-name", StyleAttribute::MASTER_PAGE},
+    {"draw:style-name", StyleAttribute::STYLE},
+    {"draw:text-style-name", StyleAttribute::STYLE},
+    {"office:value-type", StyleAttribute::VALUE_TYPE},
+    {"presentation:style-name", StyleAttribute::STYLE},
+    {"table:style-name", StyleAttribute::TABLE_STYLE},
+    {"text:style-name", StyleAttribute::STYLE},
+};
+static_assert(util::map::is_sorted(style_attributes));
+
+struct StyleAttributes {
+  pugi::xml_attribute value_type;
+  bool table_style{false};
+  // style references in document order; every attribute occurs at most once
+  std::array<pugi::xml_attribute, std::size(style_attributes)> styles;
+  std::array<bool, std::size(style_attributes)> master_page{};
+  std::size_t style_count{0};
+};
+
+// picks `a` if it is one of the style attributes
+void read_style_attribute(const pugi::xml_attribute &a,
+                          StyleAttributes &result) {
+  const auto type = util::map::lookup_static(style_attributes, a.name());
+  if (type == nullptr) {
+    return;
+  }
+  if (*type == StyleAttribute::VALUE_TYPE) {
+    result.value_type = a;
+    return;
+  }
+  result.table_style |= *type == StyleAttribute::TABLE_STYLE;
+  result.master_page[result.style_count] = *type == StyleAttribute::MASTER_PAGE;
+  result.styles[result.style_count] = a;
+  ++result.style_count;
+}
+
+StyleAttributes read_style_attributes(const pugi::xml_node &in) {
+  StyleAttributes result;
+  for (auto a = in.first_attribute(); a; a = a.next_attribute()) {
+    read_style_attribute(a, result);
+  }
+  return result;
+}
 
+void style_class_translator(const StyleAttributes &in, common::HtmlWriter &out,
+                            Context &context) {
   out << " class=\"";
 
   // TODO this is ods specific
-  if (!in.attribute("table:style-name")) {
-    const auto it =
-        context.default_cell_styles.find(context.table_cursor.col());
-    if (it != std::end(context.default_cell_styles)) {
-      style_class_translator(it->second, out, context);
-      out << " ";
+  if (!in.table_style) {
+    const std::uint32_t col = context.table_cursor.col();
+    if ((col < context.default_cell_styles.size()) &&
+        (context.default_cell_styles[col] != nullptr)) {
+      out << *context.default_cell_styles[col] << " ";
     }
   }
-  if (const auto value_type_attr = in.attribute("office:value-type");
-      value_type_attr) {
-    out << "odr-value-type-" << value_type_attr.as_string() << " ";
+  if (in.value_type) {
+    out << "odr-value-type-" << in.value_type.as_string() << " ";
   }
 
-  for (auto &&a : in.attributes()) {
-    const std::string attribute = a.name();
-    if (style_attributes.find(attribute) == std::end(style_attributes)) {
-      continue;
-    }
-    std::string name = style_translator::escape_style_name(a.as_string());
-    if (attribute == "draw:master-page-name") {
-      name = style_translator::escape_master_style_name(a.as_string());
-    }
-    style_class_translator(name, out, context);
-    out << " ";
+  for (std::size_t i = 0; i < in.style_count; ++i) {
+    out << style_class(in.styles[i].as_string(), in.master_page[i], context)
+        << " ";
   }
   out << "\"";
 }
 
-void element_attribute_translator(const pugi::xml_node &in, std::ostream &out,
-                                  Context &context) {
-  style_class_translator(in, out, context);
+void element_attribute_translator(const StyleAttributes &style,
+                                  common::HtmlWriter &out, Context &context) {
+  style_class_translator(style, out, context);
 }
 
-void element_children_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context);
-void element_translator(const pugi::xml_node &in, std::ostream &out,
+void element_attribute_translator(const pugi::xml_node &in,
+                                  common::HtmlWriter &out, Context &context) {
+  element_attribute_translator(read_style_attributes(in), out, context);
+}
+
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context);
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context);
 
-void paragraph_translator(const pugi::xml_node &in, std::ostream &out,
+void paragraph_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
   out << "<p";
   element_attribute_translator(in, out, context);
@@ -119,7 +162,8 @@ void paragraph_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</p>";
 }
 
-void space_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void space_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                      Context &) {
   const auto count = in.attribute("text:c").as_uint(1);
   if (count <= 0) {
     return;
@@ -132,16 +176,17 @@ void space_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
   out << "</span>";
 }
 
-void tab_translator(const pugi::xml_node &, std::ostream &out, Context &) {
+void tab_translator(const pugi::xml_node &, common::HtmlWriter &out,
+                    Context &) {
   out << "<span class=\"odr-whitespace\">&emsp;</span>";
 }
 
-void line_break_translator(const pugi::xml_node &, std::ostream &out,
+void line_break_translator(const pugi::xml_node &, common::HtmlWriter &out,
                            Context &) {
   out << "<br>";
 }
 
-void link_translator(const pugi::xml_node &in, std::ostream &out,
+void link_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                      Context &context) {
   out << "<a";
   if (const auto href = in.attribute("xlink:href"); href) {
@@ -159,7 +204,7 @@ void link_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</a>";
 }
 
-void bookmark_translator(const pugi::xml_node &in, std::ostream &out,
+void bookmark_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                          Context &context) {
   out << "<a";
   if (const auto id = in.attribute("text:name"); id) {
@@ -173,28 +218,48 @@ void bookmark_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</a>";
 }
 
-void frame_translator(const pugi::xml_node &in, std::ostream &out,
+struct ShapeAttributes {
+  pugi::xml_attribute width;
+  pugi::xml_attribute height;
+  pugi::xml_attribute x;
+  pugi::xml_attribute y;
+  pugi::xml_attribute anchor_type;
+};
+
+// sorted by attribute name
+constexpr util::xml::AttributeSchema<ShapeAttributes> shape_schema[]{
+    {"svg:height", &ShapeAttributes::height},
+    {"svg:width", &ShapeAttributes::width},
+    {"svg:x", &ShapeAttributes::x},
+    {"svg:y", &ShapeAttributes::y},
+    {"text:anchor-type", &ShapeAttributes::anchor_type},
+};
+static_assert(util::map::is_sorted(shape_schema));
+
+void frame_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
+  const auto attributes = util::xml::read_attributes(in, shape_schema);
+
   out << "<div style=\"";
 
-  if (const auto width_attr = in.attribute("svg:width"); width_attr) {
-    out << "width:" << width_attr.as_string() << ";";
+  if (attributes.width) {
+    out << "width:" << attributes.width.as_string() << ";";
   }
-  if (const auto height_attr = in.attribute("svg:height"); height_attr) {
-    out << "height:" << height_attr.as_string() << ";";
+  if (attributes.height) {
+    out << "height:" << attributes.height.as_string() << ";";
   }
-  if (const auto anchor_attr = in.attribute("text:anchor-type"); anchor_attr) {
-    if (anchor_attr.as_string() == std::string("char")) {
+  if (attributes.anchor_type) {
+    if (std::strcmp(attributes.anchor_type.as_string(), "char") == 0) {
       out << "position:relative;";
     }
   } else {
     out << "position:absolute;";
   }
-  if (const auto x_attr = in.attribute("svg:x"); x_attr) {
-    out << "left:" << x_attr.as_string() << ";";
+  if (attributes.x) {
+    out << "left:" << attributes.x.as_string() << ";";
   }
-  if (const auto y_attr = in.attribute("svg:y"); y_attr) {
-    out << "top:" << y_attr.as_string() << ";";
+  if (attributes.y) {
+    out << "top:" << attributes.y.as_string() << ";";
   }
 
   out << "\"";
@@ -205,9 +270,12 @@ void frame_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</div>";
 }
 
-void image_translator(const pugi::xml_node &in, std::ostream &out,
+void image_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   out << "<img style=\"width:100%;height:100%\"";
+  if (context.resources != nullptr) {
+    out << " loading=\"lazy\"";
+  }
 
   if (const auto href_attr = in.attribute("xlink:href"); href_attr) {
     const std::string href = href_attr.as_string();
@@ -217,23 +285,23 @@ void image_translator(const pugi::xml_node &in, std::ostream &out,
       const common::Path path{href};
       if (!context.filesystem->is_file(path)) {
         // TODO sometimes `ObjectReplacements` does not exist
-        out << path;
-      } else {
-        std::string image =
-            util::stream::read(*context.filesystem->open(path)->read());
-        if ((href.find("ObjectReplacements", 0) != std::string::npos) ||
-            (href.find(".svm", 0) != std::string::npos)) {
-          // TODO tellg does not work on the istream of a zip file
-          svm::SvmFile svm_file(std::make_shared<common::MemoryFile>(image));
-          std::ostringstream svg_out;
-          svm::Translator::svg(svm_file, svg_out);
-          image = svg_out.str();
-          out << "data:image/svg+xml;base64, ";
+        out << path.string();
+      } else if ((href.find("ObjectReplacements", 0) != std::string::npos) ||
+                 (href.find(".svm", 0) != std::string::npos)) {
+        const auto svg = svm::Translator::svg(
+            util::stream::read(*context.filesystem->open(path)->read()));
+        if (context.resources != nullptr) {
+          out << context.resources->write(*svg, "svg");
         } else {
-          // hacky image/jpg working according to tom
-          out << "data:image/jpg;base64, ";
+          out << "data:image/svg+xml;base64, ";
+          out.write_base64(*svg);
         }
-        out << crypto::util::base64_encode(image);
+      } else if (context.resources != nullptr) {
+        out << context.resources->write(*context.filesystem, path);
+      } else {
+        // hacky image/jpg working according to tom
+        out << "data:image/jpg;base64, ";
+        out.write_base64(*context.filesystem->open(path)->read());
       }
     } catch (...) {
       out << href;
@@ -251,7 +319,7 @@ void image_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</img>";
 }
 
-void table_translator(const pugi::xml_node &in, std::ostream &out,
+void table_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   context.table_range = {{0, 0},
                          context.config->table_limit_rows,
@@ -272,94 +340,295 @@ void table_translator(const pugi::xml_node &in, std::ostream &out,
   context.table_cursor = {};
   context.default_cell_styles.clear();
 
-  out << "<table";
-  element_attribute_translator(in, out, context);
-  out << R"( cellpadding="0" border="0" cellspacing="0")";
-  out << ">";
-  element_children_translator(in, out, context);
-  out << "</table>";
+  if (context.config->table_virtualized && !context.config->editable &&
+      (context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET)) {
+    // rows, columns and cells only go to `data`
+    common::TableData data;
+    common::HtmlWriter discard;
+    context.table_data = &data;
+    element_children_translator(in, discard, context);
+    context.table_data = nullptr;
+
+    common::HtmlWriter table_attributes;
+    element_attribute_translator(in, table_attributes, context);
+    table_attributes << R"( cellpadding="0" border="0" cellspacing="0")";
+    data.write(table_attributes.str(),
+               std::min(context.table_cursor.row(),
+                        context.table_range.to().row()),
+               out);
+  } else {
+    out << "<table";
+    element_attribute_translator(in, out, context);
+    out << R"( cellpadding="0" border="0" cellspacing="0")";
+    out << ">";
+    element_children_translator(in, out, context);
+    out << "</table>";
+  }
 
   ++context.entry;
 }
 
-void table_column_translator(const pugi::xml_node &in, std::ostream &out,
+struct TableAttributes {
+  pugi::xml_attribute columns_repeated;
+  pugi::xml_attribute rows_repeated;
+  pugi::xml_attribute columns_spanned;
+  pugi::xml_attribute rows_spanned;
+  pugi::xml_attribute default_cell_style_name;
+  StyleAttributes style;
+};
+
+// sorted by attribute name
+constexpr util::xml::AttributeSchema<TableAttributes> table_schema[]{
+    {"table:default-cell-style-name",
+     &TableAttributes::default_cell_style_name},
+    {"table:number-columns-repeated", &TableAttributes::columns_repeated},
+    {"table:number-columns-spanned", &TableAttributes::columns_spanned},
+    {"table:number-rows-repeated", &TableAttributes::rows_repeated},
+    {"table:number-rows-spanned", &TableAttributes::rows_spanned},
+};
+static_assert(util::map::is_sorted(table_schema));
+
+// the attributes of the schema and the style attributes in one pass
+TableAttributes read_table_attributes(const pugi::xml_node &in) {
+  TableAttributes result;
+  for (auto a = in.first_attribute(); a; a = a.next_attribute()) {
+    if (const auto member = util::map::lookup_static(table_schema, a.name())) {
+      result.*(*member) = a;
+    } else {
+      read_style_attribute(a, result.style);
+    }
+  }
+  return result;
+}
+
+void table_column_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                              Context &context) {
-  const auto repeated =
-      in.attribute("table:number-columns-repeated").as_uint(1);
-  const auto default_cell_style_attribute =
-      in.attribute("table:default-cell-style-name");
-  // TODO we could use span instead
+  const auto attributes = read_table_attributes(in);
+  const StyleAttributes &style = attributes.style;
+  const auto repeated = attributes.columns_repeated.as_uint(1);
+  // with compact or virtualized output all visible repetitions share one
+  // `<col span>` which is opened at the first of them
+  const bool compact =
+      context.config->table_compact || (context.table_data != nullptr);
+  common::HtmlWriter col_attributes;
+  common::HtmlWriter cell_attributes;
+  std::uint32_t first = 0;
+  std::uint32_t span = 0;
   for (std::uint32_t i = 0; i < repeated; ++i) {
     if (context.table_cursor.col() >= context.table_range.to().col())
       break;
     if (context.table_cursor.col() >= context.table_range.from().col()) {
-      if (default_cell_style_attribute) {
-        context.default_cell_styles[context.table_cursor.col()] =
-            default_cell_style_attribute.as_string();
+      if (attributes.default_cell_style_name) {
+        const std::uint32_t col = context.table_cursor.col();
+        if (col >= context.default_cell_styles.size()) {
+          context.default_cell_styles.resize(col + 1, nullptr);
+        }
+        context.default_cell_styles[col] = &style_class(
+            attributes.default_cell_style_name.as_string(), false, context);
       }
-      out << "<col";
-      element_attribute_translator(in, out, context);
-      out << ">";
+      if (!compact) {
+        out << "<col";
+        element_attribute_translator(style, out, context);
+        out << ">";
+      } else if (span == 0) {
+        first = context.table_cursor.col();
+        element_attribute_translator(style, col_attributes, context);
+        if (attributes.default_cell_style_name) {
+          // what an unstyled cell of this column gets
+          cell_attributes << " class=\""
+                          << *context.default_cell_styles[first] << " \"";
+        }
+      }
+      ++span;
     }
     context.table_cursor.add_col();
   }
+  if (!compact || (span == 0)) {
+    return;
+  }
+  if (context.table_data != nullptr) {
+    context.table_data->add_column(first, span, col_attributes.str(),
+                                   cell_attributes.str());
+    return;
+  }
+  out << "<col" << col_attributes.str();
+  if (span > 1) {
+    out << " span=\"" << span << "\"";
+  }
+  out << ">";
 }
 
-void table_row_translator(const pugi::xml_node &in, std::ostream &out,
+void table_row_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
-  const auto repeated = in.attribute("table:number-rows-repeated").as_uint(1);
+  const auto attributes = read_table_attributes(in);
+  const StyleAttributes &style = attributes.style;
+  const auto repeated = attributes.rows_repeated.as_uint(1);
+  // repetitions are identical unless rowspans shift their cells; editable
+  // output needs distinct text ids
+  const bool memoize = (repeated > 1) && !context.config->editable;
+  common::HtmlWriter rendered;
+  bool cached = false;
+  // virtualized output repeats the data of the first rendered row instead
+  common::TableData::Mark begin{};
+  common::TableData::Mark end{};
+  std::uint32_t rendered_row = 0;
   context.table_cursor.add_row(0); // TODO hacky
   for (std::uint32_t i = 0; i < repeated; ++i) {
     if (context.table_cursor.row() >= context.table_range.to().row()) {
       break;
     }
+    bool rendering = false;
     if (context.table_cursor.row() >= context.table_range.from().row()) {
-      out << "<tr";
-      element_attribute_translator(in, out, context);
-      out << ">";
-      element_children_translator(in, out, context);
-      out << "</tr>";
+      if (cached && (context.table_data != nullptr)) {
+        context.table_data->repeat(begin, end,
+                                   context.table_cursor.row() - rendered_row);
+      } else if (cached) {
+        out << rendered.str();
+      } else if (context.table_data != nullptr) {
+        rendering = memoize && !context.table_cursor.spanned();
+        begin = context.table_data->mark();
+        rendered_row = context.table_cursor.row();
+        common::HtmlWriter row_attributes;
+        element_attribute_translator(style, row_attributes, context);
+        context.table_data->add_row(rendered_row, row_attributes.str());
+        element_children_translator(in, out, context);
+        end = context.table_data->mark();
+      } else {
+        rendering = memoize && !context.table_cursor.spanned();
+        common::HtmlWriter &row_out = rendering ? rendered : out;
+        row_out << "<tr";
+        element_attribute_translator(style, row_out, context);
+        row_out << ">";
+        element_children_translator(in, row_out, context);
+        row_out << "</tr>";
+        if (rendering) {
+          out << rendered.str();
+        }
+      }
     }
     context.table_cursor.add_row();
+    if (rendering) {
+      cached = !context.table_cursor.spanned();
+    }
   }
 }
 
-void table_cell_translator(const pugi::xml_node &in, std::ostream &out,
+void table_cell_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                            Context &context) {
-  const auto repeated =
-      in.attribute("table:number-columns-repeated").as_uint(1);
-  const auto colspan = in.attribute("table:number-columns-spanned").as_uint(1);
-  const auto rowspan = in.attribute("table:number-rows-spanned").as_uint(1);
+  const auto attributes = read_table_attributes(in);
+  const StyleAttributes &style = attributes.style;
+  const auto repeated = attributes.columns_repeated.as_uint(1);
+  const auto colspan = attributes.columns_spanned.as_uint(1);
+  const auto rowspan = attributes.rows_spanned.as_uint(1);
+  // only the attributes depend on the column; editable output needs distinct
+  // text ids
+  const bool memoize = (repeated > 1) && !context.config->editable;
+  common::HtmlWriter children;
+  bool cached = false;
+  // unstyled empty cells are left to the column defaults if virtualized
+  const bool empty = !in.first_child() && (style.style_count == 0) &&
+                     !style.value_type && (colspan == 1) && (rowspan == 1);
+  // compact output merges them into one `<td colspan>` as long as the columns
+  // are adjacent and share their default style
+  const bool merge = empty && (repeated > 1) &&
+                     context.config->table_compact &&
+                     (context.table_data == nullptr);
+  const auto default_style = [&](const std::uint32_t col) {
+    return col < context.default_cell_styles.size()
+               ? context.default_cell_styles[col]
+               : nullptr;
+  };
+  common::HtmlWriter span_attributes;
+  const std::string *span_style = nullptr;
+  std::uint32_t span_end = 0;
+  std::uint32_t span = 0;
+  const auto flush_span = [&] {
+    if (span == 0) {
+      return;
+    }
+    out << "<td" << span_attributes.str();
+    if (span > 1) {
+      out << " colspan=\"" << span << "\"";
+    }
+    out << "></td>";
+    span = 0;
+  };
   for (std::uint32_t i = 0; i < repeated; ++i) {
     if (context.table_cursor.col() >= context.table_range.to().col()) {
       break;
     }
-    if (context.table_cursor.col() >= context.table_range.from().col()) {
+    const bool visible =
+        context.table_cursor.col() >= context.table_range.from().col();
+    if (visible && merge) {
+      const std::uint32_t col = context.table_cursor.col();
+      if ((col != span_end) || (default_style(col) != span_style)) {
+        flush_span();
+      }
+      if (span == 0) {
+        span_attributes.clear();
+        element_attribute_translator(style, span_attributes, context);
+        span_style = default_style(col);
+      }
+      ++span;
+      span_end = col + 1;
+    } else if (visible && (context.table_data != nullptr) && !empty) {
+      if (!cached) {
+        element_children_translator(in, children, context);
+        cached = true;
+      }
+      common::HtmlWriter cell_attributes;
+      element_attribute_translator(style, cell_attributes, context);
+      context.table_data->add_cell(
+          context.table_cursor.row(), context.table_cursor.col(), colspan,
+          rowspan, cell_attributes.str(), children.str());
+    } else if (visible && (context.table_data == nullptr)) {
       out << "<td";
-      element_attribute_translator(in, out, context);
+      element_attribute_translator(style, out, context);
       // TODO check for >1?
-      if (in.attribute("table:number-columns-spanned")) {
+      if (attributes.columns_spanned) {
         out << " colspan=\"" << colspan << "\"";
       }
-      if (in.attribute("table:number-rows-spanned")) {
+      if (attributes.rows_spanned) {
         out << " rowspan=\"" << rowspan << "\"";
       }
       out << ">";
-      element_children_translator(in, out, context);
+      if (!memoize) {
+        element_children_translator(in, out, context);
+      } else {
+        if (!cached) {
+          element_children_translator(in, children, context);
+          cached = true;
+        }
+        out << children.str();
+      }
       out << "</td>";
     }
     context.table_cursor.add_cell(colspan, rowspan);
   }
+  flush_span();
 }
 
-void draw_line_translator(const pugi::xml_node &in, std::ostream &out,
+struct LineAttributes {
+  pugi::xml_attribute x1;
+  pugi::xml_attribute y1;
+  pugi::xml_attribute x2;
+  pugi::xml_attribute y2;
+};
+
+// sorted by attribute name
+constexpr util::xml::AttributeSchema<LineAttributes> line_schema[]{
+    {"svg:x1", &LineAttributes::x1},
+    {"svg:x2", &LineAttributes::x2},
+    {"svg:y1", &LineAttributes::y1},
+    {"svg:y2", &LineAttributes::y2},
+};
+static_assert(util::map::is_sorted(line_schema));
+
+void draw_line_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
-  const auto x1 = in.attribute("svg:x1");
-  const auto y1 = in.attribute("svg:y1");
-  const auto x2 = in.attribute("svg:x2");
-  const auto y2 = in.attribute("svg:y2");
+  const auto attributes = util::xml::read_attributes(in, line_schema);
 
-  if (!x1 || !y1 || !x2 || !y2) {
+  if (!attributes.x1 || !attributes.y1 || !attributes.x2 || !attributes.y2) {
     return;
   }
 
@@ -370,31 +639,33 @@ void draw_line_translator(const pugi::xml_node &in, std::ostream &out,
 
   out << "<line";
 
-  out << " x1=\"" << x1.as_string() << "\"";
-  out << " y1=\"" << y1.as_string() << "\"";
-  out << " x2=\"" << x2.as_string() << "\"";
-  out << " y2=\"" << y2.as_string() << "\"";
+  out << " x1=\"" << attributes.x1.as_string() << "\"";
+  out << " y1=\"" << attributes.y1.as_string() << "\"";
+  out << " x2=\"" << attributes.x2.as_string() << "\"";
+  out << " y2=\"" << attributes.y2.as_string() << "\"";
   out << " />";
 
   out << "</svg>";
 }
 
-void draw_rect_translator(const pugi::xml_node &in, std::ostream &out,
+void draw_rect_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
+  const auto attributes = util::xml::read_attributes(in, shape_schema);
+
   out << "<div style=\"";
 
   out << "position:absolute;";
-  if (const auto width = in.attribute("svg:width"); width) {
-    out << "width:" << width.as_string() << ";";
+  if (attributes.width) {
+    out << "width:" << attributes.width.as_string() << ";";
   }
-  if (const auto height = in.attribute("svg:height"); height) {
-    out << "height:" << height.as_string() << ";";
+  if (attributes.height) {
+    out << "height:" << attributes.height.as_string() << ";";
   }
-  if (const auto x = in.attribute("svg:x"); x) {
-    out << "left:" << x.as_string() << ";";
+  if (attributes.x) {
+    out << "left:" << attributes.x.as_string() << ";";
   }
-  if (const auto y = in.attribute("svg:y"); y) {
-    out << "top:" << y.as_string() << ";";
+  if (attributes.y) {
+    out << "top:" << attributes.y.as_string() << ";";
   }
   out << "\"";
 
@@ -405,22 +676,24 @@ void draw_rect_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</div>";
 }
 
-void draw_circle_translator(const pugi::xml_node &in, std::ostream &out,
+void draw_circle_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                             Context &context) {
+  const auto attributes = util::xml::read_attributes(in, shape_schema);
+
   out << "<div style=\"";
 
   out << "position:absolute;";
-  if (const auto width = in.attribute("svg:width"); width) {
-    out << "width:" << width.as_string() << ";";
+  if (attributes.width) {
+    out << "width:" << attributes.width.as_string() << ";";
   }
-  if (const auto height = in.attribute("svg:height"); height) {
-    out << "height:" << height.as_string() << ";";
+  if (attributes.height) {
+    out << "height:" << attributes.height.as_string() << ";";
   }
-  if (const auto x = in.attribute("svg:x"); x) {
-    out << "left:" << x.as_string() << ";";
+  if (attributes.x) {
+    out << "left:" << attributes.x.as_string() << ";";
   }
-  if (const auto y = in.attribute("svg:y"); y) {
-    out << "top:" << y.as_string() << ";";
+  if (attributes.y) {
+    out << "top:" << attributes.y.as_string() << ";";
   }
   out << "\"";
 
@@ -431,8 +704,8 @@ void draw_circle_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</div>";
 }
 
-void element_children_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context) {
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context) {
   for (auto &&n : in) {
     if (n.type() == pugi::node_pcdata) {
       text_translator(n.text(), out, context);
@@ -442,73 +715,51 @@ void element_children_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void element_translator(const pugi::xml_node &in, std::ostream &out,
+using ElementDispatch = util::element::Dispatch<Context>;
+
+// sorted by element name
+constexpr util::map::StaticEntry<ElementDispatch::Handler> element_handlers[]{
+    {"draw:circle", ElementDispatch::translate(draw_circle_translator)},
+    {"draw:custom-shape", ElementDispatch::translate(frame_translator)},
+    {"draw:frame", ElementDispatch::translate(frame_translator)},
+    {"draw:image", ElementDispatch::translate(image_translator)},
+    {"draw:line", ElementDispatch::translate(draw_line_translator)},
+    {"draw:page", ElementDispatch::substitute("div")},
+    {"draw:rect", ElementDispatch::translate(draw_rect_translator)},
+    // ods
+    {"office:annotation", ElementDispatch::skip},
+    // odp
+    {"presentation:notes", ElementDispatch::skip},
+    {"svg:desc", ElementDispatch::skip},
+    // ods
+    {"table:covered-table-cell", ElementDispatch::skip},
+    {"table:table", ElementDispatch::translate(table_translator)},
+    {"table:table-cell", ElementDispatch::translate(table_cell_translator)},
+    {"table:table-column", ElementDispatch::translate(table_column_translator)},
+    {"table:table-row", ElementDispatch::translate(table_row_translator)},
+    // ods
+    {"table:tracked-changes", ElementDispatch::skip},
+    {"text:a", ElementDispatch::translate(link_translator)},
+    {"text:bookmark", ElementDispatch::translate(bookmark_translator)},
+    {"text:bookmark-start", ElementDispatch::translate(bookmark_translator)},
+    {"text:h", ElementDispatch::translate(paragraph_translator)},
+    // odt
+    {"text:index-title-template", ElementDispatch::skip},
+    {"text:line-break", ElementDispatch::translate(line_break_translator)},
+    {"text:list", ElementDispatch::substitute("ul")},
+    {"text:list-item", ElementDispatch::substitute("li")},
+    {"text:p", ElementDispatch::translate(paragraph_translator)},
+    {"text:s", ElementDispatch::translate(space_translator)},
+    {"text:span", ElementDispatch::substitute("span")},
+    {"text:tab", ElementDispatch::translate(tab_translator)},
+};
+static_assert(util::map::is_sorted(element_handlers));
+
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
-      {"text:span", "span"},
-      {"text:list", "ul"},
-      {"text:list-item", "li"},
-      {"draw:page", "div"},
-  };
-  static std::unordered_set<std::string> skippers{
-      "svg:desc",
-      // odt
-      "text:index-title-template",
-      // odp
-      "presentation:notes",
-      // ods
-      "office:annotation",
-      "table:tracked-changes",
-      "table:covered-table-cell",
-  };
-
-  const std::string element = in.name();
-  if (skippers.find(element) != std::end(skippers)) {
-    return;
-  }
-
-  if (element == "text:p" || element == "text:h") {
-    paragraph_translator(in, out, context);
-  } else if (element == "text:s") {
-    space_translator(in, out, context);
-  } else if (element == "text:tab") {
-    tab_translator(in, out, context);
-  } else if (element == "text:line-break") {
-    line_break_translator(in, out, context);
-  } else if (element == "text:a") {
-    link_translator(in, out, context);
-  } else if (element == "text:bookmark" || element == "text:bookmark-start") {
-    bookmark_translator(in, out, context);
-  } else if (element == "draw:frame" || element == "draw:custom-shape") {
-    frame_translator(in, out, context);
-  } else if (element == "draw:image") {
-    image_translator(in, out, context);
-  } else if (element == "table:table") {
-    table_translator(in, out, context);
-  } else if (element == "table:table-column") {
-    table_column_translator(in, out, context);
-  } else if (element == "table:table-row") {
-    table_row_translator(in, out, context);
-  } else if (element == "table:table-cell") {
-    table_cell_translator(in, out, context);
-  } else if (element == "draw:line") {
-    draw_line_translator(in, out, context);
-  } else if (element == "draw:rect") {
-    draw_rect_translator(in, out, context);
-  } else if (element == "draw:circle") {
-    draw_circle_translator(in, out, context);
-  } else {
-    const auto it = substitution.find(element);
-    if (it != std::end(substitution)) {
-      out << "<" << it->second;
-      element_attribute_translator(in, out, context);
-      out << ">";
-    }
-    element_children_translator(in, out, context);
-    if (it != std::end(substitution)) {
-      out << "</" << it->second << ">";
-    }
-  }
+  ElementDispatch::element(element_handlers, in, out, context,
+                           element_attribute_translator,
+                           element_children_translator);
 }
 } // namespace
 
@@ -1,14 +1,17 @@
 #ifndef ODR_INTERNAL_ODF_TRANSLATOR_CONTEXT_H
 #define ODR_INTERNAL_ODF_TRANSLATOR_CONTEXT_H
 
+#include <internal/common/html_writer.h>
+#include <internal/common/resource_writer.h>
 #include <internal/common/table_cursor.h>
+#include <internal/common/table_data.h>
 #include <internal/common/table_range.h>
-#include <iostream>
 #include <list>
 #include <memory>
 #include <pugixml.hpp>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace odr {
 struct HtmlConfig;
@@ -27,14 +30,21 @@ struct Context {
 
   const abstract::ReadableFilesystem *filesystem;
 
-  std::ostream *output;
+  common::HtmlWriter *output;
+  // set if the images are written as separate files
+  common::ResourceWriter *resources{nullptr};
 
   std::unordered_map<std::string, std::list<std::string>> style_dependencies;
+  // style name to class attribute value; resolved after the CSS generation
+  std::unordered_map<std::string, std::string> style_classes;
 
   std::uint32_t entry{0};
   common::TableRange table_range;
   common::TableCursor table_cursor;
-  std::unordered_map<std::uint32_t, std::string> default_cell_styles;
+  // set while a table is written virtualized
+  common::TableData *table_data{nullptr};
+  // ods; interned class attribute values by column
+  std::vector<const std::string *> default_cell_styles;
 
   // editing
   std::uint32_t current_text_translation_index{0};
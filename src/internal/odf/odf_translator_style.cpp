@@ -1,88 +1,90 @@
 #include <cstring>
 #include <glog/logging.h>
+#include <internal/common/html_writer.h>
 #include <internal/odf/odf_translator_context.h>
 #include <internal/odf/odf_translator_style.h>
-#include <internal/util/string_util.h>
+#include <internal/util/map_util.h>
 #include <pugixml.hpp>
 #include <string>
-#include <unordered_map>
 
 namespace odr::internal::odf {
 
 namespace {
 void style_properties_translator(const pugi::xml_attribute &in,
-                                 std::ostream &out) {
-  static std::unordered_map<std::string, const char *> substitution{
-      {"fo:text-align", "text-align"},
+                                 common::HtmlWriter &out) {
+  // sorted by attribute name
+  static constexpr util::map::StaticEntry<const char *> substitution[]{
+      {"draw:fill-color", "fill"},
+      {"fo:background-color", "background-color"},
+      {"fo:border", "border"},
+      {"fo:border-bottom", "border-bottom"},
+      {"fo:border-left", "border-left"},
+      {"fo:border-right", "border-right"},
+      {"fo:border-top", "border-top"},
+      {"fo:color", "color"},
       {"fo:font-size", "font-size"},
-      {"fo:font-weight", "font-weight"},
       {"fo:font-style", "font-style"},
-      {"fo:font-size", "font-size"},
-      {"fo:text-shadow", "text-shadow"},
-      {"fo:color", "color"},
-      {"fo:background-color", "background-color"},
-      {"fo:page-width", "width"},
-      {"fo:page-height", "height"},
-      {"fo:margin-top", "margin-top"},
-      {"fo:margin-right", "margin-right"},
+      {"fo:font-weight", "font-weight"},
       {"fo:margin-bottom", "margin-bottom"},
       {"fo:margin-left", "margin-left"},
+      {"fo:margin-right", "margin-right"},
+      {"fo:margin-top", "margin-top"},
       {"fo:padding", "padding"},
-      {"fo:padding-top", "padding-top"},
-      {"fo:padding-right", "padding-right"},
       {"fo:padding-bottom", "padding-bottom"},
       {"fo:padding-left", "padding-left"},
-      {"fo:border", "border"},
-      {"fo:border-top", "border-top"},
-      {"fo:border-right", "border-right"},
-      {"fo:border-bottom", "border-bottom"},
-      {"fo:border-left", "border-left"},
+      {"fo:padding-right", "padding-right"},
+      {"fo:padding-top", "padding-top"},
+      {"fo:page-height", "height"},
+      {"fo:page-width", "width"},
+      {"fo:text-align", "text-align"},
+      {"fo:text-shadow", "text-shadow"},
+      {"style:column-width", "width"},
       {"style:font-name", "font-family"},
-      {"style:width", "width"},
       {"style:height", "height"},
-      {"style:vertical-align", "vertical-align"},
-      {"style:column-width", "width"},
       {"style:row-height", "height"},
-      {"draw:fill-color", "fill"},
+      {"style:vertical-align", "vertical-align"},
+      {"style:width", "width"},
       {"svg:stroke-color", "stroke"},
       {"svg:stroke-width", "stroke-width"},
       {"text:display", "display"},
   };
+  static_assert(util::map::is_sorted(substitution));
 
-  const std::string property = in.name();
-  const auto it = substitution.find(property);
-  if (it != std::end(substitution)) {
-    out << it->second << ":" << in.as_string() << ";";
-  } else if (property == "style:text-underline-style") {
+  const char *property = in.name();
+  if (const auto css = util::map::lookup_static(substitution, property); css) {
+    out << *css << ":" << in.as_string() << ";";
+  } else if (std::strcmp(property, "style:text-underline-style") == 0) {
     // TODO breaks line-through
     if (std::strcmp(in.as_string(), "solid") == 0)
       out << "text-decoration:underline;";
-  } else if (property == "style:text-line-through-style") {
+  } else if (std::strcmp(property, "style:text-line-through-style") == 0) {
     // TODO breaks underline
     if (std::strcmp(in.as_string(), "solid") == 0)
       out << "text-decoration:line-through;";
-  } else if (property == "draw:textarea-vertical-align") {
+  } else if (std::strcmp(property, "draw:textarea-vertical-align") == 0) {
     if (std::strcmp(in.as_string(), "middle") == 0)
       out << "display:flex;justify-content:center;flex-direction: column;";
   }
 }
 
-void style_class_translator(const pugi::xml_node &in, std::ostream &out,
+void style_class_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                             Context &context) {
-  static std::unordered_map<std::string, const char *> element_to_name_attr{
+  // sorted by element name
+  static constexpr util::map::StaticEntry<const char *> element_to_name_attr[]{
       {"style:default-style", "style:family"},
-      {"style:style", "style:name"},
-      {"style:page-layout", "style:name"},
       {"style:master-page", "style:name"},
+      {"style:page-layout", "style:name"},
+      {"style:style", "style:name"},
   };
+  static_assert(util::map::is_sorted(element_to_name_attr));
 
-  const std::string element = in.name();
-  const auto it = element_to_name_attr.find(element);
-  if (it == std::end(element_to_name_attr)) {
+  const auto name_attr_name =
+      util::map::lookup_static(element_to_name_attr, in.name());
+  if (name_attr_name == nullptr) {
     return;
   }
 
-  const auto name_attr = in.attribute(it->second);
+  const auto name_attr = in.attribute(*name_attr_name);
   if (!name_attr) {
     LOG(WARNING) << "skipped style " << in.name() << ". no name attribute.";
     return;
@@ -130,7 +132,7 @@ void style_class_translator(const pugi::xml_node &in, std::ostream &out,
 }
 
 // TODO
-void list_style_translator(const pugi::xml_node &in, std::ostream &,
+void list_style_translator(const pugi::xml_node &in, common::HtmlWriter &,
                            Context &context) {
   // addElementDelegation("text:list-level-style-number", propertiesTranslator);
   // addElementDelegation("text:list-level-style-bullet", propertiesTranslator);
@@ -178,11 +180,18 @@ void list_style_translator(const pugi::xml_node &in, std::ostream &,
 } // namespace
 
 std::string style_translator::escape_style_name(const std::string &name) {
-  std::string result = name;
-  util::string::replace_all(result, ".", "_");
+  std::string result;
+  result.reserve(name.size());
+  escape_style_name(name.c_str(), result);
   return result;
 }
 
+void style_translator::escape_style_name(const char *name, std::string &out) {
+  for (; *name != '\0'; ++name) {
+    out += (*name == '.') ? '_' : *name;
+  }
+}
+
 std::string
 style_translator::escape_master_style_name(const std::string &name) {
   return "master_" + escape_style_name(name);
@@ -2,6 +2,7 @@
 #define ODR_INTERNAL_ODF_STYLE_TRANSLATOR_H
 
 #include <memory>
+#include <string>
 
 namespace pugi {
 class xml_node;
@@ -12,6 +13,8 @@ struct Context;
 
 namespace style_translator {
 std::string escape_style_name(const std::string &name);
+// appends the escaped `name` to `out`
+void escape_style_name(const char *name, std::string &out);
 std::string escape_master_style_name(const std::string &name);
 void css(const pugi::xml_node &in, Context &context);
 } // namespace style_translator
@@ -1,11 +1,20 @@
+#include <algorithm>
 #include <codecvt>
 #include <cstdint>
 #include <cstring>
 #include <internal/crypto/crypto_util.h>
 #include <internal/ooxml/ooxml_crypto.h>
 #include <internal/util/string_util.h>
+#include <internal/util/thread_util.h>
+#include <internal/util/xml_util.h>
+#include <istream>
+#include <limits>
 #include <locale>
 #include <odr/exceptions.h>
+#include <odr/file_location.h>
+#include <pugixml.hpp>
+#include <streambuf>
+#include <string_view>
 
 namespace {
 template <typename I, typename O> void to_little_endian(I in, O &out) {
@@ -21,23 +30,17 @@ template <typename I, typename O> void to_big_endian(I in, O &out) {
     in >>= 8;
   }
 }
-
-std::string xor_bytes(const std::string &a, const std::string &b) {
-  if (a.size() != b.size())
-    throw std::invalid_argument("a.size() != b.size()");
-
-  std::string result(a.size(), ' ');
-
-  for (std::size_t i = 0; i < result.size(); ++i) {
-    result[i] = a[i] ^ b[i];
-  }
-
-  return result;
-}
 } // namespace
 
 namespace odr::internal::ooxml::Crypto {
 
+namespace {
+// the package starts with the size of the decrypted data
+constexpr std::size_t package_header_size = 8;
+// AES
+constexpr std::size_t block_size = 16;
+} // namespace
+
 ECMA376Standard::ECMA376Standard(const EncryptionHeader &encryption_header,
                                  const EncryptionVerifier &encryption_verifier,
                                  std::string encrypted_verifier_hash)
@@ -69,43 +72,49 @@ std::string
 ECMA376Standard::derive_key(const std::string &password) const noexcept {
   // https://msdn.microsoft.com/en-us/library/dd925430(v=office.12).aspx
 
-  std::string hash;
-  {
-    const std::u16string password_u16 =
-        util::string::string_to_u16string(password);
-    const std::string password_u16_bytes(
-        reinterpret_cast<const char *>(password_u16.data()),
-        2 * password_u16.size());
-
-    hash = crypto::util::sha1(std::string(m_encryption_verifier.salt,
-                                          m_encryption_verifier.salt_size) +
-                              password_u16_bytes);
-    std::string ibytes(4, ' ');
-    for (std::uint32_t i = 0; i < ITER_COUNT; ++i) {
-      to_little_endian(i, ibytes);
-      hash = crypto::util::sha1(ibytes + hash);
-    }
-    to_little_endian((std::uint32_t)0, ibytes);
-    hash = crypto::util::sha1(hash + ibytes);
-  }
+  const std::string salt(m_encryption_verifier.salt,
+                         m_encryption_verifier.salt_size);
+  const std::uint32_t cb_required_key_length =
+      m_encryption_header.key_size / 8;
 
-  std::string result;
-  {
-    const std::uint32_t cb_required_key_length =
-        m_encryption_header.key_size / 8;
-    const std::uint32_t cb_hash = 20;
+  return crypto::util::cached_key(
+      "ECMA376Standard/" + std::to_string(cb_required_key_length), salt,
+      ITER_COUNT, password, [&] {
+        const std::u16string password_u16 =
+            util::string::string_to_u16string(password);
+        crypto::util::Hasher sha1(crypto::util::HashAlgorithm::SHA1);
+        constexpr std::size_t cb_hash = 20;
 
-    std::string buf1(64, '\x36');
-    buf1 = xor_bytes(hash, buf1.substr(0, cb_hash)) + buf1.substr(cb_hash);
-    const auto x1 = crypto::util::sha1(buf1);
-    std::string buf2(64, '\x5c');
-    buf2 = xor_bytes(hash, buf2.substr(0, cb_hash)) + buf2.substr(cb_hash);
-    const auto x2 = crypto::util::sha1(buf2);
-    const auto x3 = x1 + x2;
-    result = x3.substr(0, cb_required_key_length);
-  }
+        // iteration index followed by the previous hash
+        char buffer[4 + cb_hash];
+        sha1.update(salt)
+            .update(password_u16.data(), 2 * password_u16.size())
+            .final(buffer + 4);
+        for (std::uint32_t i = 0; i < ITER_COUNT; ++i) {
+          to_little_endian(i, buffer);
+          sha1.update(buffer, sizeof(buffer)).final(buffer + 4);
+        }
+        char hash[cb_hash];
+        to_little_endian(std::uint32_t(0), buffer);
+        sha1.update(buffer + 4, cb_hash).update(buffer, 4).final(hash);
 
-  return result;
+        char result[2 * cb_hash];
+        char pad[64];
+        std::memset(pad, '\x36', sizeof(pad));
+        for (std::size_t i = 0; i < cb_hash; ++i) {
+          pad[i] ^= hash[i];
+        }
+        sha1.update(pad, sizeof(pad)).final(result);
+        std::memset(pad, '\x5c', sizeof(pad));
+        for (std::size_t i = 0; i < cb_hash; ++i) {
+          pad[i] ^= hash[i];
+        }
+        sha1.update(pad, sizeof(pad)).final(result + cb_hash);
+
+        return std::string(result, std::min<std::size_t>(
+                                       cb_required_key_length, sizeof(result)));
+      },
+      [this](const std::string &key) { return verify(key); });
 }
 
 bool ECMA376Standard::verify(const std::string &key) const noexcept {
@@ -133,6 +142,251 @@ std::string ECMA376Standard::decrypt(const std::string &encrypted_package,
   return result;
 }
 
+std::string ECMA376Standard::package_key(const std::string &key) const {
+  return key;
+}
+
+std::size_t ECMA376Standard::segment_size() const noexcept {
+  return SEGMENT_SIZE;
+}
+
+void ECMA376Standard::decrypt_segment(const std::string &key,
+                                      const std::uint64_t, const char *input,
+                                      char *output,
+                                      const std::size_t size) const {
+  crypto::util::decrypt_AES(key, input, output, size);
+}
+
+namespace {
+// https://docs.microsoft.com/en-us/openspecs/office_file_formats/ms-offcrypto/a57cb947-554f-4e5e-b150-3f2978225e92
+constexpr char block_key_verifier_input[] = "\xfe\xa7\xd2\x76\x3b\x4b\x9e\x79";
+constexpr char block_key_verifier_value[] = "\xd7\xaa\x0f\x6d\x30\x61\x34\x4e";
+constexpr char block_key_key_value[] = "\x14\x6e\x0b\xe7\xab\xac\xd0\xd6";
+constexpr std::size_t block_key_size = 8;
+
+// the agile info starts with the version and reserved flags
+constexpr std::size_t agile_header_size = 8;
+constexpr char password_key_encryptor_uri[] =
+    "http://schemas.microsoft.com/office/2006/keyEncryptor/password";
+// upper bound of `spinCount` given by the specification
+constexpr std::uint32_t max_spin_count = 10000000;
+
+// truncates or pads `value` to `size`
+std::string fit(std::string value, const std::size_t size) {
+  value.resize(size, '\x36');
+  return value;
+}
+
+ECMA376Agile::Cipher read_cipher(const pugi::xml_node node) {
+  if (std::strcmp(node.attribute("cipherAlgorithm").value(), "AES") != 0 ||
+      std::strcmp(node.attribute("cipherChaining").value(),
+                  "ChainingModeCBC") != 0) {
+    throw MsUnsupportedCryptoAlgorithm();
+  }
+
+  ECMA376Agile::Cipher result;
+  result.salt =
+      crypto::util::base64_decode(node.attribute("saltValue").value());
+  result.block_size = node.attribute("blockSize").as_uint();
+  result.key_bits = node.attribute("keyBits").as_uint();
+  result.hash_size = node.attribute("hashSize").as_uint();
+
+  const std::string hash = node.attribute("hashAlgorithm").value();
+  if (hash == "SHA1") {
+    result.hash = crypto::util::HashAlgorithm::SHA1;
+  } else if (hash == "SHA256") {
+    result.hash = crypto::util::HashAlgorithm::SHA256;
+  } else if (hash == "SHA384") {
+    result.hash = crypto::util::HashAlgorithm::SHA384;
+  } else if (hash == "SHA512") {
+    result.hash = crypto::util::HashAlgorithm::SHA512;
+  } else {
+    throw MsUnsupportedCryptoAlgorithm();
+  }
+
+  if ((result.block_size != 16) || (result.salt.size() < result.block_size) ||
+      ((result.key_bits != 128) && (result.key_bits != 192) &&
+       (result.key_bits != 256))) {
+    throw MsUnsupportedCryptoAlgorithm();
+  }
+  return result;
+}
+
+// compares the name of `node` without its namespace prefix
+bool has_local_name(const pugi::xml_node node, const std::string_view name) {
+  std::string_view qualified = node.name();
+  if (const auto colon = qualified.find(':');
+      colon != std::string_view::npos) {
+    qualified.remove_prefix(colon + 1);
+  }
+  return qualified == name;
+}
+} // namespace
+
+ECMA376Agile::ECMA376Agile(const std::string &encryption_info) {
+  if (encryption_info.size() <= agile_header_size) {
+    throw MsUnsupportedCryptoAlgorithm();
+  }
+  const auto document =
+      util::xml::parse(encryption_info.substr(agile_header_size));
+  const pugi::xml_node encryption = document.child("encryption");
+
+  m_key_data = read_cipher(encryption.child("keyData"));
+
+  pugi::xml_node encrypted_key;
+  for (auto key_encryptor =
+           encryption.child("keyEncryptors").child("keyEncryptor");
+       key_encryptor;
+       key_encryptor = key_encryptor.next_sibling("keyEncryptor")) {
+    if (std::strcmp(key_encryptor.attribute("uri").value(),
+                    password_key_encryptor_uri) != 0) {
+      continue;
+    }
+    for (auto &&child : key_encryptor.children()) {
+      if (has_local_name(child, "encryptedKey")) {
+        encrypted_key = child;
+        break;
+      }
+    }
+  }
+  if (!encrypted_key) {
+    throw MsUnsupportedCryptoAlgorithm();
+  }
+
+  m_password_key = read_cipher(encrypted_key);
+  m_spin_count = encrypted_key.attribute("spinCount").as_uint();
+  m_encrypted_verifier_hash_input = crypto::util::base64_decode(
+      encrypted_key.attribute("encryptedVerifierHashInput").value());
+  m_encrypted_verifier_hash_value = crypto::util::base64_decode(
+      encrypted_key.attribute("encryptedVerifierHashValue").value());
+  m_encrypted_key_value = crypto::util::base64_decode(
+      encrypted_key.attribute("encryptedKeyValue").value());
+
+  // the values have to hold what is taken from them after decryption
+  if ((m_spin_count > max_spin_count) ||
+      (m_encrypted_verifier_hash_input.size() <
+       m_password_key.salt.size()) ||
+      (m_encrypted_verifier_hash_value.size() <
+       crypto::util::Hasher(m_password_key.hash).digest_size()) ||
+      (m_encrypted_key_value.size() < m_key_data.key_bits / 8)) {
+    throw MsUnsupportedCryptoAlgorithm();
+  }
+}
+
+std::string
+ECMA376Agile::derive_key(const std::string &password) const noexcept {
+  const std::string scheme =
+      "ECMA376Agile/" +
+      std::to_string(static_cast<int>(m_password_key.hash));
+
+  return crypto::util::cached_key(
+      scheme, m_password_key.salt, m_spin_count, password, [&] {
+        const std::u16string password_u16 =
+            util::string::string_to_u16string(password);
+        crypto::util::Hasher hasher(m_password_key.hash);
+        const std::size_t digest_size = hasher.digest_size();
+
+        // iteration index followed by the previous hash
+        char buffer[4 + crypto::util::max_digest_size];
+        hasher.update(m_password_key.salt)
+            .update(password_u16.data(), 2 * password_u16.size())
+            .final(buffer + 4);
+        for (std::uint32_t i = 0; i < m_spin_count; ++i) {
+          to_little_endian(i, buffer);
+          hasher.update(buffer, 4 + digest_size).final(buffer + 4);
+        }
+        return std::string(buffer + 4, digest_size);
+      },
+      [this](const std::string &key) { return verify(key); });
+}
+
+bool ECMA376Agile::verify(const std::string &key) const noexcept {
+  try {
+    const std::string input =
+        decrypt_key_(key, block_key_verifier_input,
+                     m_encrypted_verifier_hash_input)
+            .substr(0, m_password_key.salt.size());
+    const std::string hash = crypto::util::hash(m_password_key.hash, input);
+    const std::string value = decrypt_key_(key, block_key_verifier_value,
+                                           m_encrypted_verifier_hash_value);
+    return value.compare(0, hash.size(), hash) == 0;
+  } catch (...) {
+    // the key does not fit the cipher
+    return false;
+  }
+}
+
+std::string ECMA376Agile::decrypt(const std::string &encrypted_package,
+                                  const std::string &key) const noexcept {
+  if (encrypted_package.size() < package_header_size) {
+    return {};
+  }
+  std::uint64_t size;
+  std::memcpy(&size, encrypted_package.data(), sizeof(size));
+
+  try {
+    const std::string secret = package_key(key);
+    const char *input = encrypted_package.data() + package_header_size;
+    std::string result(encrypted_package.size() - package_header_size, '\0');
+    result.resize(result.size() - result.size() % m_key_data.block_size);
+
+    const std::size_t segments =
+        (result.size() + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    util::thread::parallel_for(
+        segments, util::thread::default_concurrency(),
+        [&](const std::size_t index) {
+          const std::size_t begin = index * SEGMENT_SIZE;
+          decrypt_segment(secret, index, input + begin, result.data() + begin,
+                          std::min(SEGMENT_SIZE, result.size() - begin));
+        });
+
+    result.resize(std::min<std::uint64_t>(size, result.size()));
+    return result;
+  } catch (...) {
+    // threads could not be started or the key does not fit the cipher
+    return {};
+  }
+}
+
+std::string ECMA376Agile::package_key(const std::string &key) const {
+  return decrypt_key_(key, block_key_key_value, m_encrypted_key_value)
+      .substr(0, m_key_data.key_bits / 8);
+}
+
+std::size_t ECMA376Agile::segment_size() const noexcept {
+  return SEGMENT_SIZE;
+}
+
+void ECMA376Agile::decrypt_segment(const std::string &key,
+                                   const std::uint64_t index,
+                                   const char *input, char *output,
+                                   const std::size_t size) const {
+  std::string salt = m_key_data.salt;
+  const std::size_t salt_size = salt.size();
+  salt.resize(salt_size + 4);
+  char *index_bytes = salt.data() + salt_size;
+  to_little_endian(static_cast<std::uint32_t>(index), index_bytes);
+  const std::string iv =
+      fit(crypto::util::hash(m_key_data.hash, salt), m_key_data.block_size);
+  crypto::util::decrypt_AES(key, iv, input, output, size);
+}
+
+std::string ECMA376Agile::decrypt_key_(const std::string &key,
+                                       const char *block_key,
+                                       const std::string &value) const {
+  const std::string derived =
+      fit(crypto::util::hash(m_password_key.hash,
+                             key + std::string(block_key, block_key_size)),
+          m_password_key.key_bits / 8);
+  const std::string iv =
+      m_password_key.salt.substr(0, m_password_key.block_size);
+  std::string result(value.size() - value.size() % m_password_key.block_size,
+                     '\0');
+  crypto::util::decrypt_AES(derived, iv, value.data(), result.data(),
+                            result.size());
+  return result;
+}
+
 Util::Util(const std::string &encryption_info) {
   {
     // big endian is not supported
@@ -149,7 +403,7 @@ Util::Util(const std::string &encryption_info) {
       (version_info.minor == 2)) {
     impl = std::make_unique<ECMA376Standard>(encryption_info);
   } else if ((version_info.major == 4) && (version_info.minor == 4)) {
-    throw MsUnsupportedCryptoAlgorithm(); // agile
+    impl = std::make_unique<ECMA376Agile>(encryption_info);
   } else if (((version_info.major == 3) || (version_info.major == 4)) &&
              (version_info.minor == 3)) {
     throw MsUnsupportedCryptoAlgorithm(); // extensible
@@ -173,4 +427,174 @@ std::string Util::decrypt(const std::string &encrypted_package,
   return impl->decrypt(encrypted_package, key);
 }
 
+std::string Util::package_key(const std::string &key) const {
+  return impl->package_key(key);
+}
+
+std::size_t Util::segment_size() const noexcept {
+  return impl->segment_size();
+}
+
+void Util::decrypt_segment(const std::string &key, const std::uint64_t index,
+                           const char *input, char *output,
+                           const std::size_t size) const {
+  impl->decrypt_segment(key, index, input, output, size);
+}
+
+struct DecryptedPackage::Source {
+  std::shared_ptr<const Algorithm> algorithm;
+  std::string key;
+  PackageReader reader;
+  std::uint64_t package_size{0};
+  std::uint64_t size{0};
+
+  // decrypts the segment `index` into `output`; returns the number of bytes
+  // which belong to the package
+  std::size_t decrypt(const std::uint64_t index, std::string &input,
+                      char *output) const {
+    const std::size_t segment_size = algorithm->segment_size();
+    const std::uint64_t begin = index * segment_size;
+    const std::uint64_t encrypted_size = package_size - package_header_size;
+    if ((begin >= size) || (begin >= encrypted_size)) {
+      return 0;
+    }
+    std::size_t length =
+        std::min<std::uint64_t>(segment_size, encrypted_size - begin);
+    length -= length % block_size;
+    input.resize(length);
+    reader(package_header_size + begin, input.data(), length);
+    algorithm->decrypt_segment(key, index, input.data(), output, length);
+    return std::min<std::uint64_t>(length, size - begin);
+  }
+};
+
+namespace {
+class PackageBuffer final : public std::streambuf {
+public:
+  explicit PackageBuffer(std::shared_ptr<const DecryptedPackage::Source> source)
+      : m_source{std::move(source)},
+        m_output(m_source->algorithm->segment_size(), '\0') {}
+
+protected:
+  int_type underflow() final {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+
+    const std::uint64_t position = position_();
+    const std::size_t segment_size = m_output.size();
+    const std::uint64_t segment = position / segment_size;
+    if (segment != m_segment) {
+      m_length = m_source->decrypt(segment, m_input, m_output.data());
+      m_segment = segment;
+    }
+
+    const std::size_t offset = position - segment * segment_size;
+    if (offset >= m_length) {
+      setg(nullptr, nullptr, nullptr);
+      m_position = position;
+      return traits_type::eof();
+    }
+    setg(m_output.data(), m_output.data() + offset,
+         m_output.data() + m_length);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  pos_type seekoff(const off_type offset, const std::ios_base::seekdir dir,
+                   const std::ios_base::openmode which) final {
+    std::int64_t base = 0;
+    if (dir == std::ios_base::cur) {
+      base = position_();
+    } else if (dir == std::ios_base::end) {
+      base = m_source->size;
+    }
+    return seekpos(base + offset, which);
+  }
+
+  pos_type seekpos(const pos_type position,
+                   const std::ios_base::openmode which) final {
+    if (((which & std::ios_base::in) == 0) || (position < 0) ||
+        (std::uint64_t(position) > m_source->size)) {
+      return pos_type(off_type(-1));
+    }
+
+    // stay inside of the decrypted segment if possible
+    const std::uint64_t segment_begin = m_segment * m_output.size();
+    if ((m_segment != std::numeric_limits<std::uint64_t>::max()) &&
+        (std::uint64_t(position) >= segment_begin) &&
+        (std::uint64_t(position) < segment_begin + m_length)) {
+      setg(m_output.data(),
+           m_output.data() + (std::uint64_t(position) - segment_begin),
+           m_output.data() + m_length);
+    } else {
+      setg(nullptr, nullptr, nullptr);
+      m_position = position;
+    }
+    return position;
+  }
+
+private:
+  std::shared_ptr<const DecryptedPackage::Source> m_source;
+  std::string m_input;
+  std::string m_output;
+  // the decrypted segment in `m_output`
+  std::uint64_t m_segment{std::numeric_limits<std::uint64_t>::max()};
+  std::size_t m_length{0};
+  // used while no segment is loaded
+  std::uint64_t m_position{0};
+
+  [[nodiscard]] std::uint64_t position_() const {
+    if (eback() == nullptr) {
+      return m_position;
+    }
+    return m_segment * m_output.size() + (gptr() - eback());
+  }
+};
+
+class PackageIstream final : public std::istream {
+public:
+  explicit PackageIstream(std::unique_ptr<PackageBuffer> sbuf)
+      : std::istream(sbuf.get()), m_sbuf{std::move(sbuf)} {}
+
+private:
+  std::unique_ptr<PackageBuffer> m_sbuf;
+};
+} // namespace
+
+DecryptedPackage::DecryptedPackage(std::shared_ptr<const Algorithm> algorithm,
+                                   const std::string &key, PackageReader reader,
+                                   const std::uint64_t package_size) {
+  if (package_size < package_header_size) {
+    throw FileReadError();
+  }
+
+  std::uint64_t size;
+  char header[package_header_size];
+  reader(0, header, sizeof(header));
+  std::memcpy(&size, header, sizeof(size));
+  // the segments could not cover a larger size
+  if (size > package_size - package_header_size) {
+    throw FileReadError();
+  }
+
+  auto source = std::make_shared<Source>();
+  source->key = algorithm->package_key(key);
+  source->algorithm = std::move(algorithm);
+  source->reader = std::move(reader);
+  source->package_size = package_size;
+  source->size = size;
+  m_source = std::move(source);
+}
+
+FileLocation DecryptedPackage::location() const noexcept {
+  return FileLocation::MEMORY;
+}
+
+std::size_t DecryptedPackage::size() const { return m_source->size; }
+
+std::unique_ptr<std::istream> DecryptedPackage::read() const {
+  return std::make_unique<PackageIstream>(
+      std::make_unique<PackageBuffer>(m_source));
+}
+
 } // namespace odr::internal::ooxml::Crypto
@@ -1,6 +1,11 @@
 #ifndef ODR_INTERNAL_OOXML_CRYPTO_H
 #define ODR_INTERNAL_OOXML_CRYPTO_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <internal/abstract/file.h>
+#include <internal/crypto/crypto_util.h>
 #include <memory>
 #include <string>
 
@@ -55,6 +60,16 @@ public:
   [[nodiscard]] virtual std::string
   decrypt(const std::string &encrypted_package,
           const std::string &key) const noexcept = 0;
+
+  // the key the package is encrypted with; `key` is the derived one
+  [[nodiscard]] virtual std::string
+  package_key(const std::string &key) const = 0;
+  // the package is encrypted in segments which can be decrypted on their own
+  [[nodiscard]] virtual std::size_t segment_size() const noexcept = 0;
+  // `key` is the package key; `size` is a multiple of the cipher block size
+  virtual void decrypt_segment(const std::string &key, std::uint64_t index,
+                               const char *input, char *output,
+                               std::size_t size) const = 0;
 };
 
 class ECMA376Standard final : public Algorithm {
@@ -70,14 +85,69 @@ public:
   decrypt(const std::string &encrypted_package,
           const std::string &key) const noexcept final;
 
+  [[nodiscard]] std::string package_key(const std::string &key) const final;
+  [[nodiscard]] std::size_t segment_size() const noexcept final;
+  void decrypt_segment(const std::string &key, std::uint64_t index,
+                       const char *input, char *output,
+                       std::size_t size) const final;
+
 private:
   static constexpr auto ITER_COUNT = 50000;
+  // ECB; any multiple of the block size would do
+  static constexpr std::size_t SEGMENT_SIZE = 4096;
 
   EncryptionHeader m_encryption_header;
   EncryptionVerifier m_encryption_verifier;
   std::string m_encrypted_verifier_hash;
 };
 
+class ECMA376Agile final : public Algorithm {
+public:
+  // https://docs.microsoft.com/en-us/openspecs/office_file_formats/ms-offcrypto/87020a34-e73f-4139-99bc-bbdf6cf6fa55
+  explicit ECMA376Agile(const std::string &encryption_info);
+
+  // the hashed password; the keys are derived from it
+  [[nodiscard]] std::string
+  derive_key(const std::string &password) const noexcept final;
+  [[nodiscard]] bool verify(const std::string &key) const noexcept final;
+  // decrypts the segments on multiple threads
+  [[nodiscard]] std::string
+  decrypt(const std::string &encrypted_package,
+          const std::string &key) const noexcept final;
+
+  [[nodiscard]] std::string package_key(const std::string &key) const final;
+  [[nodiscard]] std::size_t segment_size() const noexcept final;
+  // CBC with an initialization vector per segment
+  void decrypt_segment(const std::string &key, std::uint64_t index,
+                       const char *input, char *output,
+                       std::size_t size) const final;
+
+  struct Cipher {
+    std::string salt;
+    std::size_t block_size{0};
+    std::size_t key_bits{0};
+    std::size_t hash_size{0};
+    crypto::util::HashAlgorithm hash{crypto::util::HashAlgorithm::SHA1};
+  };
+
+private:
+  static constexpr std::size_t SEGMENT_SIZE = 4096;
+
+  // `keyData`; encrypts the package
+  Cipher m_key_data;
+  // `encryptedKey` of the password key encryptor
+  Cipher m_password_key;
+  std::uint32_t m_spin_count{0};
+  std::string m_encrypted_verifier_hash_input;
+  std::string m_encrypted_verifier_hash_value;
+  std::string m_encrypted_key_value;
+
+  // decrypts `value` with the key derived from `key` and `block_key`
+  [[nodiscard]] std::string decrypt_key_(const std::string &key,
+                                         const char *block_key,
+                                         const std::string &value) const;
+};
+
 class Util final : public Algorithm {
 public:
   explicit Util(const std::string &encryption_info);
@@ -90,10 +160,39 @@ public:
   decrypt(const std::string &encrypted_package,
           const std::string &key) const noexcept final;
 
+  [[nodiscard]] std::string package_key(const std::string &key) const final;
+  [[nodiscard]] std::size_t segment_size() const noexcept final;
+  void decrypt_segment(const std::string &key, std::uint64_t index,
+                       const char *input, char *output,
+                       std::size_t size) const final;
+
 private:
   std::unique_ptr<Algorithm> impl;
 };
 
+// reads `length` bytes at `offset` of the `EncryptedPackage` stream
+using PackageReader =
+    std::function<void(std::uint64_t offset, char *buffer, std::size_t length)>;
+
+// the decrypted `EncryptedPackage`; the segments are decrypted as they are
+// read. the streams are seekable so archives can be opened on top of it
+class DecryptedPackage final : public abstract::File {
+public:
+  // `key` is the derived key
+  DecryptedPackage(std::shared_ptr<const Algorithm> algorithm,
+                   const std::string &key, PackageReader reader,
+                   std::uint64_t package_size);
+
+  [[nodiscard]] FileLocation location() const noexcept final;
+  [[nodiscard]] std::size_t size() const final;
+  [[nodiscard]] std::unique_ptr<std::istream> read() const final;
+
+  struct Source;
+
+private:
+  std::shared_ptr<const Source> m_source;
+};
+
 } // namespace Crypto
 
 } // namespace odr::internal::ooxml
@@ -2,27 +2,28 @@
 #include <glog/logging.h>
 #include <internal/abstract/file.h>
 #include <internal/abstract/filesystem.h>
+#include <internal/common/html_writer.h>
 #include <internal/common/path.h>
-#include <internal/crypto/crypto_util.h>
 #include <internal/ooxml/ooxml_document_translator.h>
 #include <internal/ooxml/ooxml_translator_context.h>
-#include <internal/util/stream_util.h>
+#include <internal/util/element_util.h>
+#include <internal/util/map_util.h>
+#include <internal/util/number_util.h>
 #include <internal/util/string_util.h>
 #include <odr/html_config.h>
 #include <pugixml.hpp>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace odr::internal::ooxml {
 
 namespace {
-void alignment_translator(const pugi::xml_node &in, std::ostream &out,
+void alignment_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &) {
   out << "text-align:" << in.attribute("w:val").as_string() << ";";
 }
 
-void font_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void font_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                     Context &) {
   const auto font_attr = in.attribute("w:cs");
   if (!font_attr) {
     return;
@@ -30,7 +31,7 @@ void font_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
   out << "font-family:" << font_attr.as_string() << ";";
 }
 
-void font_size_translator(const pugi::xml_node &in, std::ostream &out,
+void font_size_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &) {
   const auto size_attr = in.attribute("w:val");
   if (!size_attr) {
@@ -40,7 +41,8 @@ void font_size_translator(const pugi::xml_node &in, std::ostream &out,
   out << "font-size:" << size << "pt;";
 }
 
-void bold_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void bold_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                     Context &) {
   const auto val_attr = in.attribute("w:val");
   if (val_attr) {
     return;
@@ -48,7 +50,8 @@ void bold_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
   out << "font-weight:bold;";
 }
 
-void italic_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void italic_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                       Context &) {
   const auto val_attr = in.attribute("w:val");
   if (val_attr) {
     return;
@@ -56,7 +59,7 @@ void italic_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
   out << "font-style:italic;";
 }
 
-void underline_translator(const pugi::xml_node &in, std::ostream &out,
+void underline_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &) {
   const auto val_attr = in.attribute("w:val");
   if (std::strcmp(val_attr.as_string(), "single") == 0) {
@@ -65,8 +68,8 @@ void underline_translator(const pugi::xml_node &in, std::ostream &out,
   // TODO wont work with strike_through_translator
 }
 
-void strike_through_translator(const pugi::xml_node &in, std::ostream &out,
-                               Context &) {
+void strike_through_translator(const pugi::xml_node &in,
+                               common::HtmlWriter &out, Context &) {
   // TODO wont work with underline_translator
 
   const auto val_attr = in.attribute("w:val");
@@ -76,11 +79,13 @@ void strike_through_translator(const pugi::xml_node &in, std::ostream &out,
   out << "text-decoration:line-through;";
 }
 
-void shadow_translator(const pugi::xml_node &, std::ostream &out, Context &) {
+void shadow_translator(const pugi::xml_node &, common::HtmlWriter &out,
+                       Context &) {
   out << "text-shadow:1pt 1pt;";
 }
 
-void color_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void color_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                      Context &) {
   const auto val_attr = in.attribute("w:val");
   if (std::strcmp(val_attr.as_string(), "auto") == 0) {
     return;
@@ -92,7 +97,7 @@ void color_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
   }
 }
 
-void highlight_translator(const pugi::xml_node &in, std::ostream &out,
+void highlight_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &) {
   const auto val_attr = in.attribute("w:val");
   if (std::strcmp(val_attr.as_string(), "auto") == 0) {
@@ -105,35 +110,37 @@ void highlight_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void indentation_translator(const pugi::xml_node &in, std::ostream &out,
+void indentation_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                             Context &) {
   const auto left_attr = in.attribute("w:left");
   if (left_attr) {
-    out << "margin-left:" << left_attr.as_float() / 1440.0f << "in;";
+    out << "margin-left:"
+        << util::number::twip_to_inch(left_attr.as_double()) << "in;";
   }
 
   const auto right_attr = in.attribute("w:right");
   if (right_attr) {
-    out << "margin-right:" << right_attr.as_float() / 1440.0f << "in;";
+    out << "margin-right:"
+        << util::number::twip_to_inch(right_attr.as_double()) << "in;";
   }
 }
 
-void table_cell_width_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &) {
+void table_cell_width_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &) {
   const auto width_attr = in.attribute("w:w");
   const auto type_attr = in.attribute("w:type");
   if (!width_attr) {
     return;
   }
-  float width = width_attr.as_float();
+  double width = width_attr.as_double();
   if (type_attr && std::strcmp(type_attr.as_string(), "dxa") == 0) {
-    width /= 1440.0f;
+    width = util::number::twip_to_inch(width);
   }
   out << "width:" << width << "in;";
 }
 
-void table_cell_border_translator(const pugi::xml_node &in, std::ostream &out,
-                                  Context &) {
+void table_cell_border_translator(const pugi::xml_node &in,
+                                  common::HtmlWriter &out, Context &) {
   auto translator = [&](const char *name, const pugi::xml_node &e) {
     out << name << ":";
 
@@ -141,7 +148,7 @@ void table_cell_border_translator(const pugi::xml_node &in, std::ostream &out,
     if (std::strcmp(val, "nil") == 0) {
       out << "none";
     } else {
-      const float sizePt = e.attribute("w:sz").as_float() / 2.0f;
+      const double sizePt = e.attribute("w:sz").as_double() / 2.0;
       out << sizePt << "pt ";
 
       out << "solid ";
@@ -174,42 +181,39 @@ void table_cell_border_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void translate_style_inline(const pugi::xml_node &in, std::ostream &out,
+using StyleTranslator = void (*)(const pugi::xml_node &,
+                                 common::HtmlWriter &, Context &);
+
+// sorted by element name
+constexpr util::map::StaticEntry<StyleTranslator> style_translators[]{
+    {"w:b", bold_translator},
+    {"w:color", color_translator},
+    {"w:highlight", highlight_translator},
+    {"w:i", italic_translator},
+    {"w:ind", indentation_translator},
+    {"w:jc", alignment_translator},
+    {"w:rFonts", font_translator},
+    {"w:shadow", shadow_translator},
+    {"w:strike", strike_through_translator},
+    {"w:sz", font_size_translator},
+    {"w:tcBorders", table_cell_border_translator},
+    {"w:tcW", table_cell_width_translator},
+    {"w:u", underline_translator},
+};
+static_assert(util::map::is_sorted(style_translators));
+
+void translate_style_inline(const pugi::xml_node &in, common::HtmlWriter &out,
                             Context &context) {
   for (auto &&e : in.children()) {
-    const std::string element = e.name();
-
-    if (element == "w:jc") {
-      alignment_translator(e, out, context);
-    } else if (element == "w:rFonts") {
-      font_translator(e, out, context);
-    } else if (element == "w:sz") {
-      font_size_translator(e, out, context);
-    } else if (element == "w:b") {
-      bold_translator(e, out, context);
-    } else if (element == "w:i") {
-      italic_translator(e, out, context);
-    } else if (element == "w:u") {
-      underline_translator(e, out, context);
-    } else if (element == "w:strike") {
-      strike_through_translator(e, out, context);
-    } else if (element == "w:shadow") {
-      shadow_translator(e, out, context);
-    } else if (element == "w:color") {
-      color_translator(e, out, context);
-    } else if (element == "w:highlight") {
-      highlight_translator(e, out, context);
-    } else if (element == "w:ind") {
-      indentation_translator(e, out, context);
-    } else if (element == "w:tcW") {
-      table_cell_width_translator(e, out, context);
-    } else if (element == "w:tcBorders") {
-      table_cell_border_translator(e, out, context);
+    if (const auto translator =
+            util::map::lookup_static(style_translators, e.name());
+        translator) {
+      (*translator)(e, out, context);
     }
   }
 }
 
-void style_class_translator(const pugi::xml_node &in, std::ostream &out,
+void style_class_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                             Context &context) {
   std::string name = "unknown";
   if (const auto name_attr = in.attribute("w:styleId"); name_attr) {
@@ -249,9 +253,7 @@ void style_class_translator(const pugi::xml_node &in, std::ostream &out,
 
 void document_translator::css(const pugi::xml_node &in, Context &context) {
   for (auto &&e : in.children()) {
-    const std::string element = e.name();
-
-    if (element == "w:style") {
+    if (std::strcmp(e.name(), "w:style") == 0) {
       style_class_translator(e, *context.output, context);
     }
     // else if (element == "w:docDefaults") DefaultStyleTranslator(e,
@@ -260,25 +262,22 @@ void document_translator::css(const pugi::xml_node &in, Context &context) {
 }
 
 namespace {
-void text_translator(const pugi::xml_text &in, std::ostream &out,
+void text_translator(const pugi::xml_text &in, common::HtmlWriter &out,
                      Context &context) {
-  std::string text = in.as_string();
-  util::string::replace_all(text, "&", "&amp;");
-  util::string::replace_all(text, "<", "&lt;");
-  util::string::replace_all(text, ">", "&gt;");
-
   if (!context.config->editable) {
-    out << text;
+    out.write_escaped(in.as_string());
   } else {
     out << R"(<span contenteditable="true" data-odr-cid=")"
-        << context.current_text_translation_index << "\">" << text << "</span>";
+        << context.current_text_translation_index << "\">";
+    out.write_escaped(in.as_string());
+    out << "</span>";
     context.text_translation[context.current_text_translation_index] = in;
     ++context.current_text_translation_index;
   }
 }
 
-void style_attribute_translator(const pugi::xml_node &in, std::ostream &out,
-                                Context &context) {
+void style_attribute_translator(const pugi::xml_node &in,
+                                common::HtmlWriter &out, Context &context) {
   const std::string prefix = in.name();
 
   const pugi::xml_node style =
@@ -296,21 +295,22 @@ void style_attribute_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void element_attribute_translator(const pugi::xml_node &in, std::ostream &out,
-                                  Context &context) {
+void element_attribute_translator(const pugi::xml_node &in,
+                                  common::HtmlWriter &out, Context &context) {
   style_attribute_translator(in, out, context);
 }
 
-void element_children_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context);
-void element_translator(const pugi::xml_node &in, std::ostream &out,
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context);
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context);
 
-void tab_translator(const pugi::xml_node &, std::ostream &out, Context &) {
+void tab_translator(const pugi::xml_node &, common::HtmlWriter &out,
+                    Context &) {
   out << "\t";
 }
 
-void paragraph_translator(const pugi::xml_node &in, std::ostream &out,
+void paragraph_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
   const pugi::xml_node num = in.child("w:pPr").child("w:numPr");
   int listing_level;
@@ -354,7 +354,7 @@ void paragraph_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void span_translator(const pugi::xml_node &in, std::ostream &out,
+void span_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                      Context &context) {
   out << "<span";
   element_attribute_translator(in, out, context);
@@ -363,7 +363,7 @@ void span_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</span>";
 }
 
-void hyperlink_translator(const pugi::xml_node &in, std::ostream &out,
+void hyperlink_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
   out << "<a";
 
@@ -380,14 +380,14 @@ void hyperlink_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</a>";
 }
 
-void bookmark_translator(const pugi::xml_node &in, std::ostream &out,
+void bookmark_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                          Context &) {
   if (const auto name_attr = in.attribute("w:name"); name_attr) {
     out << "<a id=\"" << name_attr.as_string() << "\"/>";
   }
 }
 
-void table_translator(const pugi::xml_node &in, std::ostream &out,
+void table_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   out << R"(<table border="0" cellspacing="0" cellpadding="0")";
   element_attribute_translator(in, out, context);
@@ -396,7 +396,7 @@ void table_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</table>";
 }
 
-void drawings_translator(const pugi::xml_node &in, std::ostream &out,
+void drawings_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                          Context &context) {
   // ooxml is using amazing units
   // https://startbigthinksmall.wordpress.com/2010/01/04/points-inches-and-emus-measuring-units-in-office-open-xml/
@@ -414,8 +414,10 @@ void drawings_translator(const pugi::xml_node &in, std::ostream &out,
   out << "<div";
 
   if (const auto sizeEle = child.child("wp:extent"); sizeEle) {
-    const float widthIn = sizeEle.attribute("cx").as_float() / 914400.0f;
-    const float heightIn = sizeEle.attribute("cy").as_float() / 914400.0f;
+    const double widthIn =
+        util::number::emu_to_inch(sizeEle.attribute("cx").as_double());
+    const double heightIn =
+        util::number::emu_to_inch(sizeEle.attribute("cy").as_double());
     out << " style=\"width:" << widthIn << "in;height:" << heightIn << "in;\"";
   }
 
@@ -424,7 +426,7 @@ void drawings_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</div>";
 }
 
-void image_translator(const pugi::xml_node &in, std::ostream &out,
+void image_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   out << "<img style=\"width:100%;height:100%\"";
 
@@ -435,21 +437,25 @@ void image_translator(const pugi::xml_node &in, std::ostream &out,
   } else {
     const char *r_id_attr = ref.attribute("r:embed").as_string();
     const auto path = common::Path("word").join(context.relations[r_id_attr]);
-    out << " alt=\"Error: image not found or unsupported: " << path << "\"";
-    out << " src=\"";
-    std::string image =
-        util::stream::read(*context.filesystem->open(path)->read());
-    // hacky image/jpg working according to tom
-    out << "data:image/jpg;base64, ";
-    out << crypto::util::base64_encode(image);
+    out << " alt=\"Error: image not found or unsupported: " << path.string()
+        << "\"";
+    if (context.resources != nullptr) {
+      out << " loading=\"lazy\" src=\"";
+      out << context.resources->write(*context.filesystem, path);
+    } else {
+      out << " src=\"";
+      // hacky image/jpg working according to tom
+      out << "data:image/jpg;base64, ";
+      out.write_base64(*context.filesystem->open(path)->read());
+    }
     out << "\"";
   }
 
   out << "></img>";
 }
 
-void element_children_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context) {
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context) {
   for (auto &&n : in) {
     if (n.type() == pugi::node_pcdata) {
       text_translator(n.text(), out, context);
@@ -459,49 +465,29 @@ void element_children_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void element_translator(const pugi::xml_node &in, std::ostream &out,
+using ElementDispatch = util::element::Dispatch<Context>;
+
+// sorted by element name
+constexpr util::map::StaticEntry<ElementDispatch::Handler> element_handlers[]{
+    {"pic:pic", ElementDispatch::translate(image_translator)},
+    {"w:bookmarkStart", ElementDispatch::translate(bookmark_translator)},
+    {"w:drawing", ElementDispatch::translate(drawings_translator)},
+    {"w:hyperlink", ElementDispatch::translate(hyperlink_translator)},
+    {"w:instrText", ElementDispatch::skip},
+    {"w:p", ElementDispatch::translate(paragraph_translator)},
+    {"w:r", ElementDispatch::translate(span_translator)},
+    {"w:tab", ElementDispatch::translate(tab_translator)},
+    {"w:tbl", ElementDispatch::translate(table_translator)},
+    {"w:tc", ElementDispatch::substitute("td")},
+    {"w:tr", ElementDispatch::substitute("tr")},
+};
+static_assert(util::map::is_sorted(element_handlers));
+
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
-      {"w:tr", "tr"},
-      {"w:tc", "td"},
-  };
-  static std::unordered_set<std::string> skippers{
-      "w:instrText",
-  };
-
-  const std::string element = in.name();
-  if (skippers.find(element) != std::end(skippers)) {
-    return;
-  }
-
-  if (element == "w:tab") {
-    tab_translator(in, out, context);
-  } else if (element == "w:p") {
-    paragraph_translator(in, out, context);
-  } else if (element == "w:r") {
-    span_translator(in, out, context);
-  } else if (element == "w:hyperlink") {
-    hyperlink_translator(in, out, context);
-  } else if (element == "w:bookmarkStart") {
-    bookmark_translator(in, out, context);
-  } else if (element == "w:tbl") {
-    table_translator(in, out, context);
-  } else if (element == "w:drawing") {
-    drawings_translator(in, out, context);
-  } else if (element == "pic:pic") {
-    image_translator(in, out, context);
-  } else {
-    const auto it = substitution.find(element);
-    if (it != std::end(substitution)) {
-      out << "<" << it->second;
-      element_attribute_translator(in, out, context);
-      out << ">";
-    }
-    element_children_translator(in, out, context);
-    if (it != std::end(substitution)) {
-      out << "</" << it->second << ">";
-    }
-  }
+  ElementDispatch::element(element_handlers, in, out, context,
+                           element_attribute_translator,
+                           element_children_translator);
 }
 } // namespace
 
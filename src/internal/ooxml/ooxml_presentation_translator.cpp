@@ -2,40 +2,45 @@
 #include <glog/logging.h>
 #include <internal/abstract/file.h>
 #include <internal/abstract/filesystem.h>
+#include <internal/common/html_writer.h>
 #include <internal/common/path.h>
-#include <internal/crypto/crypto_util.h>
 #include <internal/ooxml/ooxml_presentation_translator.h>
 #include <internal/ooxml/ooxml_translator_context.h>
-#include <internal/util/stream_util.h>
+#include <internal/util/element_util.h>
+#include <internal/util/map_util.h>
+#include <internal/util/number_util.h>
 #include <internal/util/string_util.h>
 #include <odr/html_config.h>
 #include <pugixml.hpp>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace odr::internal::ooxml {
 
 namespace {
-void xfrm_translator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void xfrm_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                     Context &) {
   if (const auto off_ele = in.child("a:off"); off_ele) {
-    const float x_in = off_ele.attribute("x").as_float() / 914400.0f;
-    const float y_in = off_ele.attribute("y").as_float() / 914400.0f;
+    const double x_in =
+        util::number::emu_to_inch(off_ele.attribute("x").as_double());
+    const double y_in =
+        util::number::emu_to_inch(off_ele.attribute("y").as_double());
     out << "position:absolute;";
     out << "left:" << x_in << "in;";
     out << "top:" << y_in << "in;";
   }
 
   if (const auto ext_ele = in.child("a:ext"); ext_ele) {
-    const float cx_in = ext_ele.attribute("cx").as_float() / 914400.0f;
-    const float cy_in = ext_ele.attribute("cy").as_float() / 914400.0f;
+    const double cx_in =
+        util::number::emu_to_inch(ext_ele.attribute("cx").as_double());
+    const double cy_in =
+        util::number::emu_to_inch(ext_ele.attribute("cy").as_double());
     out << "width:" << cx_in << "in;";
     out << "height:" << cy_in << "in;";
   }
 }
 
-void border_translator(const std::string &property, const pugi::xml_node &in,
-                       std::ostream &out, Context &) {
+void border_translator(const char *property, const pugi::xml_node &in,
+                       common::HtmlWriter &out, Context &) {
   const auto w_attr = in.attribute("w");
   if (!w_attr) {
     return;
@@ -51,7 +56,7 @@ void border_translator(const std::string &property, const pugi::xml_node &in,
     return;
   }
 
-  out << property << ":" << w_attr.as_float() / 14400.0f << "pt solid ";
+  out << property << ":" << w_attr.as_double() / 14400.0 << "pt solid ";
   if (std::strlen(val_attr.as_string()) == 6) {
     out << "#";
   }
@@ -59,8 +64,8 @@ void border_translator(const std::string &property, const pugi::xml_node &in,
   out << ";";
 }
 
-void background_color_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &) {
+void background_color_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &) {
   const auto color_ele = in.child("a:srgbClr");
   if (!color_ele) {
     return;
@@ -79,49 +84,49 @@ void background_color_translator(const pugi::xml_node &in, std::ostream &out,
   out << ";";
 }
 
-void margin_attributes_translator(const pugi::xml_node &in, std::ostream &out,
-                                  Context &) {
+void margin_attributes_translator(const pugi::xml_node &in,
+                                  common::HtmlWriter &out, Context &) {
   const auto mar_l_attr = in.attribute("marL");
   if (mar_l_attr) {
-    const float mar_l_in = mar_l_attr.as_float() / 914400.0f;
+    const double mar_l_in = util::number::emu_to_inch(mar_l_attr.as_double());
     out << "margin-left:" << mar_l_in << "in;";
   }
 
   const auto mar_r_attr = in.attribute("marR");
   if (mar_r_attr) {
-    const float mar_r_in = mar_r_attr.as_float() / 914400.0f;
+    const double mar_r_in = util::number::emu_to_inch(mar_r_attr.as_double());
     out << "margin-right:" << mar_r_in << "in;";
   }
 }
 
-void table_cell_property_translator(const pugi::xml_node &in, std::ostream &out,
-                                    Context &context) {
+void table_cell_property_translator(const pugi::xml_node &in,
+                                    common::HtmlWriter &out, Context &context) {
   margin_attributes_translator(in, out, context);
 
   for (auto &&e : in) {
-    const std::string element = e.name();
+    const char *element = e.name();
 
-    if (element == "a:lnL") {
+    if (std::strcmp(element, "a:lnL") == 0) {
       border_translator("border-left", e, out, context);
-    } else if (element == "a:lnR") {
+    } else if (std::strcmp(element, "a:lnR") == 0) {
       border_translator("border-right", e, out, context);
-    } else if (element == "a:lnT") {
+    } else if (std::strcmp(element, "a:lnT") == 0) {
       border_translator("border-top", e, out, context);
-    } else if (element == "a:lnB") {
+    } else if (std::strcmp(element, "a:lnB") == 0) {
       border_translator("border-bottom", e, out, context);
-    } else if (element == "a:solidFill") {
+    } else if (std::strcmp(element, "a:solidFill") == 0) {
       background_color_translator(e, out, context);
     }
   }
 }
 
-void default_property_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context) {
+void default_property_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context) {
   margin_attributes_translator(in, out, context);
 
   const auto sz_attr = in.attribute("sz");
   if (sz_attr) {
-    float szPt = sz_attr.as_float() / 100.0f;
+    const double szPt = sz_attr.as_double() / 100.0;
     out << "font-size:" << szPt << "pt;";
   }
 
@@ -151,25 +156,22 @@ void default_property_translator(const pugi::xml_node &in, std::ostream &out,
 void presentation_translator::css(const pugi::xml_node &, Context &) {}
 
 namespace {
-void text_translator(const pugi::xml_text &in, std::ostream &out,
+void text_translator(const pugi::xml_text &in, common::HtmlWriter &out,
                      Context &context) {
-  std::string text = in.as_string();
-  util::string::replace_all(text, "&", "&amp;");
-  util::string::replace_all(text, "<", "&lt;");
-  util::string::replace_all(text, ">", "&gt;");
-
   if (!context.config->editable) {
-    out << text;
+    out.write_escaped(in.as_string());
   } else {
     out << R"(<span contenteditable="true" data-odr-cid=")"
-        << context.current_text_translation_index << "\">" << text << "</span>";
+        << context.current_text_translation_index << "\">";
+    out.write_escaped(in.as_string());
+    out << "</span>";
     context.text_translation[context.current_text_translation_index] = in;
     ++context.current_text_translation_index;
   }
 }
 
-void style_attribute_translator(const pugi::xml_node &in, std::ostream &out,
-                                Context &context) {
+void style_attribute_translator(const pugi::xml_node &in,
+                                common::HtmlWriter &out, Context &context) {
   const auto p_pr = in.child("a:pPr");
   const auto r_pr = in.child("a:rPr");
   const auto sp_pr = in.child("p:spPr");
@@ -202,26 +204,28 @@ void style_attribute_translator(const pugi::xml_node &in, std::ostream &out,
       xfrm_translator(xfrm_pr, out, context);
     }
     if (w_attr) {
-      out << "width:" << (w_attr.as_float() / 914400.0f) << "in;";
+      out << "width:" << util::number::emu_to_inch(w_attr.as_double())
+          << "in;";
     }
     if (h_attr) {
-      out << "height:" << (h_attr.as_float() / 914400.0f) << "in;";
+      out << "height:" << util::number::emu_to_inch(h_attr.as_double())
+          << "in;";
     }
     out << "\"";
   }
 }
 
-void element_attribute_translator(const pugi::xml_node &in, std::ostream &out,
-                                  Context &context) {
+void element_attribute_translator(const pugi::xml_node &in,
+                                  common::HtmlWriter &out, Context &context) {
   style_attribute_translator(in, out, context);
 }
 
-void element_children_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context);
-void element_translator(const pugi::xml_node &in, std::ostream &out,
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context);
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context);
 
-void paragraph_translator(const pugi::xml_node &in, std::ostream &out,
+void paragraph_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
   out << "<p";
   element_attribute_translator(in, out, context);
@@ -267,7 +271,7 @@ void paragraph_translator(const pugi::xml_node &in, std::ostream &out,
   out << "</p>";
 }
 
-void span_translator(const pugi::xml_node &in, std::ostream &out,
+void span_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                      Context &context) {
   bool link = false;
   const auto hlink_click = in.child("a:rPr").child("a:hlinkClick");
@@ -289,14 +293,14 @@ void span_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void slide_translator(const pugi::xml_node &in, std::ostream &out,
+void slide_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   out << "<div class=\"slide\">";
   element_children_translator(in, out, context);
   out << "</div>";
 }
 
-void table_translator(const pugi::xml_node &in, std::ostream &out,
+void table_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   out << R"(<table border="0" cellspacing="0" cellpadding="0")";
   element_attribute_translator(in, out, context);
@@ -306,7 +310,7 @@ void table_translator(const pugi::xml_node &in, std::ostream &out,
 }
 
 // TODO duplicated in document translation
-void image_translator(const pugi::xml_node &in, std::ostream &out,
+void image_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                       Context &context) {
   out << "<img";
   element_attribute_translator(in, out, context);
@@ -319,21 +323,25 @@ void image_translator(const pugi::xml_node &in, std::ostream &out,
     const auto r_id_attr = ref.attribute("r:embed");
     const auto path = common::Path("ppt/slides")
                           .join(context.relations[r_id_attr.as_string()]);
-    out << " alt=\"Error: image not found or unsupported: " << path << "\"";
-    out << " src=\"";
-    std::string image =
-        util::stream::read(*context.filesystem->open(path)->read());
-    // hacky image/jpg working according to tom
-    out << "data:image/jpg;base64, ";
-    out << crypto::util::base64_encode(image);
+    out << " alt=\"Error: image not found or unsupported: " << path.string()
+        << "\"";
+    if (context.resources != nullptr) {
+      out << " loading=\"lazy\" src=\"";
+      out << context.resources->write(*context.filesystem, path);
+    } else {
+      out << " src=\"";
+      // hacky image/jpg working according to tom
+      out << "data:image/jpg;base64, ";
+      out.write_base64(*context.filesystem->open(path)->read());
+    }
     out << "\"";
   }
 
   out << "></img>";
 }
 
-void element_children_translator(const pugi::xml_node &in, std::ostream &out,
-                                 Context &context) {
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context) {
   for (auto &&n : in) {
     if (n.type() == pugi::node_pcdata) {
       text_translator(n.text(), out, context);
@@ -343,45 +351,29 @@ void element_children_translator(const pugi::xml_node &in, std::ostream &out,
   }
 }
 
-void element_translator(const pugi::xml_node &in, std::ostream &out,
+using ElementDispatch = util::element::Dispatch<Context>;
+
+// sorted by element name
+constexpr util::map::StaticEntry<ElementDispatch::Handler> element_handlers[]{
+    {"a:gridCol", ElementDispatch::substitute("col")},
+    {"a:p", ElementDispatch::translate(paragraph_translator)},
+    {"a:r", ElementDispatch::translate(span_translator)},
+    {"a:tbl", ElementDispatch::translate(table_translator)},
+    {"a:tblGrid", ElementDispatch::substitute("colgroup")},
+    {"a:tc", ElementDispatch::substitute("td")},
+    {"a:tr", ElementDispatch::substitute("tr")},
+    {"p:cSld", ElementDispatch::translate(slide_translator)},
+    {"p:graphicFrame", ElementDispatch::substitute("div")},
+    {"p:pic", ElementDispatch::translate(image_translator)},
+    {"p:sp", ElementDispatch::substitute("div")},
+};
+static_assert(util::map::is_sorted(element_handlers));
+
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
-      {"p:sp", "div"},
-      {"p:graphicFrame", "div"},
-      {"a:tblGrid", "colgroup"},
-      {"a:gridCol", "col"},
-      {"a:tr", "tr"},
-      {"a:tc", "td"},
-  };
-  static std::unordered_set<std::string> skippers{};
-
-  const std::string element = in.name();
-  if (skippers.find(element) != std::end(skippers)) {
-    return;
-  }
-
-  if (element == "a:p") {
-    paragraph_translator(in, out, context);
-  } else if (element == "a:r") {
-    span_translator(in, out, context);
-  } else if (element == "p:cSld") {
-    slide_translator(in, out, context);
-  } else if (element == "a:tbl") {
-    table_translator(in, out, context);
-  } else if (element == "p:pic") {
-    image_translator(in, out, context);
-  } else {
-    const auto it = substitution.find(element);
-    if (it != std::end(substitution)) {
-      out << "<" << it->second;
-      element_attribute_translator(in, out, context);
-      out << ">";
-    }
-    element_children_translator(in, out, context);
-    if (it != std::end(substitution)) {
-      out << "</" << it->second << ">";
-    }
-  }
+  ElementDispatch::element(element_handlers, in, out, context,
+                           element_attribute_translator,
+                           element_children_translator);
 }
 } // namespace
 
@@ -1,9 +1,15 @@
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <internal/abstract/filesystem.h>
 #include <internal/cfb/cfb_archive.h>
+#include <internal/cfb/cfb_util.h>
 #include <internal/common/archive.h>
 #include <internal/common/html.h>
+#include <internal/common/html_writer.h>
 #include <internal/common/path.h>
+#include <internal/common/resource_writer.h>
+#include <internal/common/spill_file.h>
 #include <internal/ooxml/ooxml_crypto.h>
 #include <internal/ooxml/ooxml_document_translator.h>
 #include <internal/ooxml/ooxml_meta.h>
@@ -11,18 +17,23 @@
 #include <internal/ooxml/ooxml_translator.h>
 #include <internal/ooxml/ooxml_translator_context.h>
 #include <internal/ooxml/ooxml_workbook_translator.h>
+#include <internal/util/number_util.h>
 #include <internal/util/stream_util.h>
+#include <internal/util/thread_util.h>
 #include <internal/util/xml_util.h>
 #include <internal/zip/zip_archive.h>
+#include <memory>
 #include <odr/exceptions.h>
 #include <odr/file_meta.h>
 #include <odr/html_config.h>
+#include <optional>
 #include <pugixml.hpp>
+#include <vector>
 
 namespace odr::internal::ooxml {
 
 namespace {
-void generate_style(std::ofstream &out, Context &context) {
+void generate_style(common::HtmlWriter &out, Context &context) {
   // default css
   out << common::Html::default_style();
 
@@ -42,8 +53,10 @@ void generate_style(std::ofstream &out, Context &context) {
     if (!size_ele) {
       break;
     }
-    const float width_in = size_ele.attribute("cx").as_float() / 914400.0f;
-    const float height_in = size_ele.attribute("cy").as_float() / 914400.0f;
+    const double width_in =
+        util::number::emu_to_inch(size_ele.attribute("cx").as_double());
+    const double height_in =
+        util::number::emu_to_inch(size_ele.attribute("cy").as_double());
 
     out << ".slide {";
     out << "width:" << width_in << "in;";
@@ -59,95 +72,206 @@ void generate_style(std::ofstream &out, Context &context) {
   }
 }
 
-void generate_script(std::ofstream &out, Context &) {
+void generate_script(common::HtmlWriter &out, Context &context) {
   out << common::Html::default_script();
+
+  if ((context.meta->type == FileType::OFFICE_OPEN_XML_WORKBOOK) &&
+      context.config->table_virtualized && !context.config->editable) {
+    out << common::Html::virtual_table_script();
+  }
 }
 
-void generate_content(Context &context) {
-  context.entry = 0;
+// a slide, a sheet or the whole text document
+struct Entry {
+  std::uint32_t index;
+  common::Path path;
+};
 
-  switch (context.meta->type) {
-  case FileType::OFFICE_OPEN_XML_DOCUMENT: {
-    const auto content =
-        util::xml::parse(*context.filesystem, "word/document.xml");
-    context.relations =
-        parse_relationships(*context.filesystem, "word/document.xml");
+bool entry_selected(const std::uint32_t entry, const HtmlConfig &config) {
+  return (entry >= config.entry_offset) &&
+         ((config.entry_count == 0) ||
+          (entry < config.entry_offset + config.entry_count));
+}
 
-    const auto body = content.child("w:document").child("w:body");
-    document_translator::html(body, context);
-  } break;
-  case FileType::OFFICE_OPEN_XML_PRESENTATION: {
-    const auto ppt =
-        util::xml::parse(*context.filesystem, "ppt/presentation.xml");
-    const auto ppt_relations =
-        parse_relationships(*context.filesystem, "ppt/presentation.xml");
-
-    for (auto &&e : ppt.select_nodes("//p:sldId")) {
-      const std::string rId = e.node().attribute("r:id").as_string();
-
-      const auto path = common::Path("ppt").join(ppt_relations.at(rId));
-      const auto content = util::xml::parse(*context.filesystem, path);
-      context.relations = parse_relationships(*context.filesystem, path);
-
-      if ((context.config->entry_offset > 0) ||
-          (context.config->entry_count > 0)) {
-        if ((context.entry >= context.config->entry_offset) &&
-            (context.entry <
-             context.config->entry_offset + context.config->entry_count)) {
-          presentation_translator::html(content, context);
-        }
-      } else {
-        presentation_translator::html(content, context);
-      }
+std::vector<Entry> selected_entries(const Context &context) {
+  std::vector<Entry> result;
 
-      ++context.entry;
-    }
-  } break;
-  case FileType::OFFICE_OPEN_XML_WORKBOOK: {
-    const auto xls = util::xml::parse(*context.filesystem, "xl/workbook.xml");
-    const auto xls_relations =
-        parse_relationships(*context.filesystem, "xl/workbook.xml");
-
-    // TODO this breaks back translation
-    pugi::xml_document shared_strings;
-    if (context.filesystem->is_file("xl/sharedStrings.xml")) {
-      shared_strings =
-          util::xml::parse(*context.filesystem, "xl/sharedStrings.xml");
-      for (auto &&e : shared_strings.select_nodes("//si")) {
-        context.shared_strings.push_back(e.node());
+  const auto add_entries = [&](const common::Path &base, const char *xpath) {
+    const auto index = util::xml::parse(*context.filesystem, base);
+    const auto relations = parse_relationships(*context.filesystem, base);
+
+    std::uint32_t entry = 0;
+    for (auto &&e : index.select_nodes(xpath)) {
+      if (entry_selected(entry, *context.config)) {
+        const std::string rId = e.node().attribute("r:id").as_string();
+        result.push_back({entry, base.parent().join(relations.at(rId))});
       }
+      ++entry;
     }
+  };
 
-    for (auto &&e : xls.select_nodes("//sheet")) {
-      const std::string rId = e.node().attribute("r:id").as_string();
-
-      const auto path = common::Path("xl").join(xls_relations.at(rId));
-      const auto content = util::xml::parse(*context.filesystem, path);
-      context.relations = parse_relationships(*context.filesystem, path);
-
-      if ((context.config->entry_offset > 0) ||
-          (context.config->entry_count > 0)) {
-        if ((context.entry >= context.config->entry_offset) &&
-            (context.entry <
-             context.config->entry_offset + context.config->entry_count)) {
-          workbook_translator::html(content, context);
-        }
-      } else {
-        workbook_translator::html(content, context);
-      }
+  switch (context.meta->type) {
+  case FileType::OFFICE_OPEN_XML_DOCUMENT:
+    result.push_back({0, "word/document.xml"});
+    break;
+  case FileType::OFFICE_OPEN_XML_PRESENTATION:
+    add_entries("ppt/presentation.xml", "//p:sldId");
+    break;
+  case FileType::OFFICE_OPEN_XML_WORKBOOK:
+    add_entries("xl/workbook.xml", "//sheet");
+    break;
+  default:
+    throw std::invalid_argument("file.getMeta().type");
+  }
 
-      ++context.entry;
+  return result;
+}
+
+// `shared_strings` has to outlive the translation if the output is editable;
+// otherwise the strings are translated once and the document is released
+void parse_shared_strings(pugi::xml_document &shared_strings,
+                          Context &context) {
+  if ((context.meta->type != FileType::OFFICE_OPEN_XML_WORKBOOK) ||
+      !context.filesystem->is_file("xl/sharedStrings.xml")) {
+    return;
+  }
+  // TODO this breaks back translation
+  shared_strings =
+      util::xml::parse(*context.filesystem, "xl/sharedStrings.xml");
+  if (context.config->editable) {
+    for (auto &&e : shared_strings.select_nodes("//si")) {
+      context.shared->shared_string_nodes.push_back(e.node());
     }
-  } break;
+    return;
+  }
+  workbook_translator::shared_strings(shared_strings.child("sst"), context);
+  shared_strings.reset();
+}
+
+void generate_entry(const Entry &entry, Context &context) {
+  const auto content = util::xml::parse(*context.filesystem, entry.path);
+  context.relations = parse_relationships(*context.filesystem, entry.path);
+  context.entry = entry.index;
+
+  switch (context.meta->type) {
+  case FileType::OFFICE_OPEN_XML_DOCUMENT:
+    document_translator::html(content.child("w:document").child("w:body"),
+                              context);
+    break;
+  case FileType::OFFICE_OPEN_XML_PRESENTATION:
+    presentation_translator::html(content, context);
+    break;
+  case FileType::OFFICE_OPEN_XML_WORKBOOK:
+    workbook_translator::html(content, context);
+    break;
   default:
     throw std::invalid_argument("file.getMeta().type");
   }
 }
+
+void generate_content(Context &context) {
+  pugi::xml_document shared_strings;
+  parse_shared_strings(shared_strings, context);
+
+  const auto entries = selected_entries(context);
+
+  // editable output numbers the texts across all entries
+  if (!context.config->parallel || context.config->editable) {
+    for (auto &&entry : entries) {
+      generate_entry(entry, context);
+    }
+    return;
+  }
+
+  // every entry is rendered into a buffer of its own; written in order
+  std::vector<std::unique_ptr<common::HtmlWriter>> buffers(entries.size());
+  util::thread::parallel_for(
+      entries.size(), util::thread::default_concurrency(),
+      [&](const std::size_t index) {
+        buffers[index] = std::make_unique<common::HtmlWriter>();
+        Context entry_context = context;
+        entry_context.output = buffers[index].get();
+        generate_entry(entries[index], entry_context);
+      });
+  for (auto &&buffer : buffers) {
+    *context.output << buffer->str();
+  }
+}
+
+void generate_entry_file(const Entry &entry, const common::Path &directory,
+                         Context &context) {
+  std::ofstream ostream(
+      directory.join("entry-" + std::to_string(entry.index) + ".html").path());
+  if (!ostream.is_open()) {
+    throw FileNotCreated();
+  }
+  common::HtmlWriter out(ostream);
+
+  context.output = &out;
+
+  out << common::Html::doctype();
+  out << "<html><head>";
+  out << common::Html::default_headers();
+  out << R"(<link rel="stylesheet" href="style.css"/>)";
+  out << "</head>";
+
+  out << "<body " << common::Html::body_attributes(*context.config) << ">";
+  generate_entry(entry, context);
+  out << "</body>";
+
+  out << R"(<script src="script.js"></script>)";
+  out << "</html>";
+
+  context.output = nullptr;
+  out.flush();
+}
+
+// one file per entry next to the shared `style.css` and `script.js`
+void generate_entries(const common::Path &directory, Context &context) {
+  std::filesystem::create_directories(directory.path());
+
+  {
+    std::ofstream ostream(directory.join("style.css").path());
+    if (!ostream.is_open()) {
+      throw FileNotCreated();
+    }
+    common::HtmlWriter out(ostream);
+    context.output = &out;
+    generate_style(out, context);
+    context.shared->style_classes =
+        common::Html::style_classes(context.shared->style_dependencies);
+    context.output = nullptr;
+    out.flush();
+  }
+
+  {
+    std::ofstream ostream(directory.join("script.js").path());
+    if (!ostream.is_open()) {
+      throw FileNotCreated();
+    }
+    common::HtmlWriter out(ostream);
+    generate_script(out, context);
+    out.flush();
+  }
+
+  pugi::xml_document shared_strings;
+  parse_shared_strings(shared_strings, context);
+
+  const auto entries = selected_entries(context);
+  // the shared parts are only read; every entry gets its own mutable state
+  util::thread::parallel_for(
+      entries.size(), util::thread::default_concurrency(),
+      [&](const std::size_t index) {
+        Context entry_context = context;
+        generate_entry_file(entries[index], directory, entry_context);
+      });
+}
 } // namespace
 
 OfficeOpenXmlTranslator::OfficeOpenXmlTranslator(
-    std::shared_ptr<abstract::ReadableFilesystem> filesystem)
-    : m_filesystem{std::move(filesystem)} {
+    std::shared_ptr<abstract::ReadableFilesystem> filesystem,
+    std::shared_ptr<common::MemoryBudget> budget)
+    : m_filesystem{std::move(filesystem)}, m_budget{std::move(budget)} {
   m_meta = parse_file_meta(*m_filesystem);
 }
 
@@ -179,16 +303,34 @@ bool OfficeOpenXmlTranslator::decrypt(const std::string &password) {
   const std::string encryption_info =
       util::stream::read(*m_filesystem->open("/EncryptionInfo")->read());
   // TODO cache Crypto::Util
-  Crypto::Util util(encryption_info);
-  const std::string key = util.derive_key(password);
-  if (!util.verify(key)) {
+  auto util = std::make_shared<Crypto::Util>(encryption_info);
+  const std::string key = util->derive_key(password);
+  if (!util->verify(key)) {
     return false;
   }
-  const std::string encrypted_package =
-      util::stream::read(*m_filesystem->open("/EncryptedPackage")->read());
-  const std::string decrypted_package = util.decrypt(encrypted_package, key);
+
+  // the package is decrypted segment by segment while the archive is read
+  const auto encrypted_package = m_filesystem->open("/EncryptedPackage");
+  Crypto::PackageReader reader;
+  if (const auto cfb_file =
+          std::dynamic_pointer_cast<cfb::util::FileInCfb>(encrypted_package)) {
+    reader = [cfb_file](const std::uint64_t offset, char *buffer,
+                        const std::size_t length) {
+      cfb_file->read_at(offset, buffer, length);
+    };
+  } else {
+    auto content =
+        std::make_shared<common::SpillFile>(*encrypted_package, m_budget);
+    reader = [content](const std::uint64_t offset, char *buffer,
+                       const std::size_t length) {
+      std::memcpy(buffer, content->content().data() + offset, length);
+    };
+  }
+  auto decrypted_package = std::make_shared<Crypto::DecryptedPackage>(
+      util, key, std::move(reader), encrypted_package->size());
+
   common::ArchiveFile<zip::ReadonlyZipArchive> zip(
-      std::make_shared<common::MemoryFile>(decrypted_package));
+      std::static_pointer_cast<abstract::File>(decrypted_package));
   m_filesystem = zip.archive()->filesystem();
   m_meta = parse_file_meta(*m_filesystem);
   m_decrypted = true;
@@ -198,22 +340,53 @@ bool OfficeOpenXmlTranslator::decrypt(const std::string &password) {
 void OfficeOpenXmlTranslator::translate(const common::Path &path,
                                         const HtmlConfig &config) {
   // TODO throw if not decrypted
-  std::ofstream out(path.path());
-  if (!out.is_open()) {
+  // the entries of split output share the directory of the resources
+  std::optional<common::ResourceWriter> resources;
+  if (config.external_resources) {
+    const auto directory =
+        config.split_entries ? path.path() : path.path().parent_path();
+    resources.emplace(directory / config.external_resource_path,
+                      config.external_resource_path);
+  }
+
+  if (config.split_entries) {
+    m_shared = {};
+    m_context = {};
+    m_context.config = &config;
+    m_context.meta = &m_meta;
+    m_context.filesystem = m_filesystem.get();
+    m_context.shared = &m_shared;
+    m_context.resources = resources ? &*resources : nullptr;
+
+    generate_entries(path, m_context);
+
+    m_context.config = nullptr;
+    m_context.resources = nullptr;
+    return;
+  }
+
+  std::ofstream ostream(path.path());
+  if (!ostream.is_open()) {
     throw FileNotCreated();
   }
+  common::HtmlWriter out(ostream);
 
+  m_shared = {};
   m_context = {};
   m_context.config = &config;
   m_context.meta = &m_meta;
   m_context.filesystem = m_filesystem.get();
+  m_context.shared = &m_shared;
   m_context.output = &out;
+  m_context.resources = resources ? &*resources : nullptr;
 
   out << common::Html::doctype();
   out << "<html><head>";
   out << common::Html::default_headers();
   out << "<style>";
   generate_style(out, m_context);
+  m_context.shared->style_classes =
+      common::Html::style_classes(m_context.shared->style_dependencies);
   out << "</style>";
   out << "</head>";
 
@@ -228,7 +401,9 @@ void OfficeOpenXmlTranslator::translate(const common::Path &path,
 
   m_context.config = nullptr;
   m_context.output = nullptr;
-  out.close();
+  m_context.resources = nullptr;
+  out.flush();
+  ostream.close();
 }
 
 void OfficeOpenXmlTranslator::edit(const std::string &) {
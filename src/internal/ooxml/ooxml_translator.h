@@ -11,12 +11,18 @@ namespace odr::internal::abstract {
 class ReadableFilesystem;
 }
 
+namespace odr::internal::common {
+class MemoryBudget;
+}
+
 namespace odr::internal::ooxml {
 
 class OfficeOpenXmlTranslator final : public abstract::DocumentTranslator {
 public:
-  explicit OfficeOpenXmlTranslator(
-      std::shared_ptr<abstract::ReadableFilesystem> filesystem);
+  // intermediate buffers of the document are kept within `budget`
+  OfficeOpenXmlTranslator(
+      std::shared_ptr<abstract::ReadableFilesystem> filesystem,
+      std::shared_ptr<common::MemoryBudget> budget);
   OfficeOpenXmlTranslator(const OfficeOpenXmlTranslator &) = delete;
   OfficeOpenXmlTranslator(OfficeOpenXmlTranslator &&) noexcept;
   ~OfficeOpenXmlTranslator() final;
@@ -41,11 +47,13 @@ public:
 
 private:
   std::shared_ptr<abstract::ReadableFilesystem> m_filesystem;
+  std::shared_ptr<common::MemoryBudget> m_budget;
 
   FileMeta m_meta;
 
   bool m_decrypted{false};
 
+  SharedContext m_shared;
   Context m_context;
   pugi::xml_document m_style;
   pugi::xml_document m_content;
@@ -1,13 +1,17 @@
 #ifndef ODR_INTERNAL_OOXML_TRANSLATOR_CONTEXT_H
 #define ODR_INTERNAL_OOXML_TRANSLATOR_CONTEXT_H
 
+#include <internal/common/html_writer.h>
+#include <internal/common/resource_writer.h>
 #include <internal/common/table_cursor.h>
+#include <internal/common/table_data.h>
 #include <internal/common/table_range.h>
-#include <iostream>
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <pugixml.hpp>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -22,21 +26,53 @@ class ReadableFilesystem;
 
 namespace odr::internal::ooxml {
 
+// translated shared strings of a workbook; one arena of html and the offsets
+// of the strings into it
+struct SharedStrings {
+  std::string html;
+  // string `i` is [`offsets[i]`, `offsets[i + 1]`)
+  std::vector<std::size_t> offsets{0};
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return offsets.size() - 1;
+  }
+
+  [[nodiscard]] std::string_view operator[](const std::size_t index) const {
+    return std::string_view(html).substr(offsets[index],
+                                         offsets[index + 1] - offsets[index]);
+  }
+};
+
+// state of the whole document; only read while the entries are translated
+struct SharedContext {
+  std::unordered_map<std::string, std::list<std::string>> style_dependencies;
+  // style name to class attribute value; resolved after the CSS generation
+  std::unordered_map<std::string, std::string> style_classes;
+  // xlsx; editable output needs the text nodes so the nodes are kept instead
+  SharedStrings shared_strings;
+  std::vector<pugi::xml_node> shared_string_nodes;
+};
+
+// state of the translation of one entry; cheap to copy
 struct Context {
   const HtmlConfig *config;
   const FileMeta *meta;
 
   const abstract::ReadableFilesystem *filesystem;
 
-  std::ostream *output;
+  SharedContext *shared;
+
+  common::HtmlWriter *output;
+  // set if the images are written as separate files
+  common::ResourceWriter *resources{nullptr};
 
-  std::unordered_map<std::string, std::list<std::string>> style_dependencies;
   std::unordered_map<std::string, std::string> relations;
-  std::vector<pugi::xml_node> shared_strings; // xlsx
 
   std::uint32_t entry{0};
   common::TableRange table_range;
   common::TableCursor table_cursor;
+  // set while a table is written virtualized
+  common::TableData *table_data{nullptr};
 
   // editing
   std::uint32_t current_text_translation_index{0};
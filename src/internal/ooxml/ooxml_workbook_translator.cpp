@@ -1,23 +1,25 @@
+#include <algorithm>
 #include <cstring>
 #include <glog/logging.h>
 #include <internal/abstract/file.h>
 #include <internal/abstract/filesystem.h>
+#include <internal/common/html_writer.h>
 #include <internal/common/path.h>
+#include <internal/common/table_data.h>
 #include <internal/crypto/crypto_util.h>
 #include <internal/ooxml/ooxml_translator_context.h>
 #include <internal/ooxml/ooxml_workbook_translator.h>
+#include <internal/util/element_util.h>
+#include <internal/util/map_util.h>
 #include <internal/util/stream_util.h>
-#include <internal/util/string_util.h>
 #include <odr/html_config.h>
 #include <pugixml.hpp>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace odr::internal::ooxml {
 
 namespace {
-void fonts_translator(pugi::xml_node in, std::ostream &out, Context &) {
+void fonts_translator(pugi::xml_node in, common::HtmlWriter &out, Context &) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
     out << ".font-" << i << " {";
@@ -46,7 +48,7 @@ void fonts_translator(pugi::xml_node in, std::ostream &out, Context &) {
   }
 }
 
-void fills_translator(pugi::xml_node in, std::ostream &out, Context &) {
+void fills_translator(pugi::xml_node in, common::HtmlWriter &out, Context &) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
     out << ".fill-" << i << " {";
@@ -65,7 +67,7 @@ void fills_translator(pugi::xml_node in, std::ostream &out, Context &) {
   }
 }
 
-void borders_translator(pugi::xml_node in, std::ostream &out, Context &) {
+void borders_translator(pugi::xml_node in, common::HtmlWriter &out, Context &) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
     out << ".border-" << i << " {";
@@ -76,7 +78,7 @@ void borders_translator(pugi::xml_node in, std::ostream &out, Context &) {
   }
 }
 
-void cell_xfs_translator(pugi::xml_node in, std::ostream &out,
+void cell_xfs_translator(pugi::xml_node in, common::HtmlWriter &out,
                          Context &context) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
@@ -85,19 +87,19 @@ void cell_xfs_translator(pugi::xml_node in, std::ostream &out,
     if (const auto apply_font = e.attribute("applyFont");
         apply_font && (std::strcmp(apply_font.as_string(), "true") == 0 ||
                        std::strcmp(apply_font.as_string(), "1") == 0)) {
-      context.style_dependencies[name].push_back(
+      context.shared->style_dependencies[name].push_back(
           std::string("font-") + e.attribute("fontId").as_string());
     }
 
     if (const auto fill_id = e.attribute("fillId"); fill_id) {
-      context.style_dependencies[name].push_back(std::string("fill-") +
-                                                 fill_id.as_string());
+      context.shared->style_dependencies[name].push_back(
+          std::string("fill-") + fill_id.as_string());
     }
 
     if (const auto apply_border = e.attribute("fillId");
         apply_border && (std::strcmp(apply_border.as_string(), "true") == 0 ||
                          std::strcmp(apply_border.as_string(), "1") == 0)) {
-      context.style_dependencies[name].push_back(
+      context.shared->style_dependencies[name].push_back(
           std::string("border-") + e.attribute("borderId").as_string());
     }
 
@@ -125,7 +127,7 @@ void cell_xfs_translator(pugi::xml_node in, std::ostream &out,
 } // namespace
 
 void workbook_translator::css(const pugi::xml_node &in, Context &context) {
-  std::ostream &out = *context.output;
+  common::HtmlWriter &out = *context.output;
 
   if (const auto fonts = in.child("fonts"); fonts) {
     fonts_translator(fonts, out, context);
@@ -145,76 +147,99 @@ void workbook_translator::css(const pugi::xml_node &in, Context &context) {
 }
 
 namespace {
-void text_translator(pugi::xml_node in, std::ostream &out, Context &context) {
-  std::string text = in.value();
-  util::string::replace_all(text, "&", "&amp;");
-  util::string::replace_all(text, "<", "&lt;");
-  util::string::replace_all(text, ">", "&gt;");
-
+void text_translator(pugi::xml_node in, common::HtmlWriter &out,
+                     Context &context) {
   if (!context.config->editable) {
-    out << text;
+    out.write_escaped(in.value());
   } else {
     out << R"(<span contenteditable="true" data-odr-cid=")"
-        << context.current_text_translation_index << "\">" << text << "</span>";
+        << context.current_text_translation_index << "\">";
+    out.write_escaped(in.value());
+    out << "</span>";
     context.text_translation[context.current_text_translation_index] = in;
     ++context.current_text_translation_index;
   }
 }
 
-void style_attribute_translator(pugi::xml_node in, std::ostream &out,
+void style_attribute_translator(pugi::xml_node in, common::HtmlWriter &out,
                                 Context &) {
-  const std::string prefix = in.name();
-
   const auto width = in.attribute("width");
   const auto ht = in.attribute("ht");
   if (width || ht) {
     out << " style=\"";
     if (width) {
-      out << "width:" << width.as_float() << "in;";
+      out << "width:" << width.as_double() << "in;";
     }
     if (ht) {
-      out << "height:" << ht.as_float() << "pt;";
+      out << "height:" << ht.as_double() << "pt;";
     }
     out << "\"";
   }
 }
 
-void element_attribute_translator(pugi::xml_node in, std::ostream &out,
-                                  Context &context) {
+void element_attribute_translator(const pugi::xml_node &in,
+                                  common::HtmlWriter &out, Context &context) {
   if (const auto s = in.attribute("s"); s) {
-    const std::string name = std::string("cellxf-") + s.as_string();
-    out << " class=\"";
-    out << name;
-
-    { // handle style dependencies
-      const auto it = context.style_dependencies.find(name);
-      if (it == std::end(context.style_dependencies)) {
-        // TODO remove ?
-        LOG(WARNING) << "unknown style: " << name;
-      } else {
-        for (auto i = it->second.rbegin(); i != it->second.rend(); ++i) {
-          out << " " << *i;
-        }
-      }
+    // reused to avoid an allocation per styled cell
+    static thread_local std::string name;
+    name.assign("cellxf-").append(s.as_string());
+
+    // the shared context is read only here; unknown styles are not interned
+    const auto &style_classes = context.shared->style_classes;
+    if (const auto it = style_classes.find(name);
+        it != std::end(style_classes)) {
+      out << " class=\"" << it->second << "\"";
+    } else {
+      // TODO remove ?
+      DLOG(WARNING) << "unknown style: " << name;
+      out << " class=\"" << name << "\"";
     }
-
-    out << "\"";
   }
 
   style_attribute_translator(in, out, context);
 }
 
-void element_children_translator(pugi::xml_node in, std::ostream &out,
-                                 Context &context);
-void element_translator(pugi::xml_node in, std::ostream &out, Context &context);
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context);
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                        Context &context);
+
+// number of the `count` rows or columns starting at `begin` which fall into
+// [`from`, `to`)
+std::uint32_t visible_span(const std::uint32_t begin, const std::uint32_t count,
+                           const std::uint32_t from,
+                           const std::uint32_t to) noexcept {
+  const std::uint32_t first = std::max(begin, from);
+  const std::uint32_t last = std::min(begin + count, to);
+  return first < last ? last - first : 0;
+}
 
-void table_translator(pugi::xml_node in, std::ostream &out, Context &context) {
+void table_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                      Context &context) {
   // TODO context.config->tableLimitByDimensions
   context.table_range = {{0, 0},
                          context.config->table_limit_rows,
                          context.config->table_limit_cols};
   context.table_cursor = {};
 
+  if (context.config->table_virtualized && !context.config->editable) {
+    // rows, columns and cells only go to `data`
+    common::TableData data;
+    common::HtmlWriter discard;
+    context.table_data = &data;
+    element_children_translator(in, discard, context);
+    context.table_data = nullptr;
+
+    common::HtmlWriter table_attributes;
+    table_attributes << R"( border="0" cellspacing="0" cellpadding="0")";
+    element_attribute_translator(in, table_attributes, context);
+    data.write(table_attributes.str(),
+               std::min(context.table_cursor.row(),
+                        context.table_range.to().row()),
+               out);
+    return;
+  }
+
   out << R"(<table border="0" cellspacing="0" cellpadding="0")";
   element_attribute_translator(in, out, context);
   out << ">";
@@ -222,7 +247,7 @@ void table_translator(pugi::xml_node in, std::ostream &out, Context &context) {
   out << "</table>";
 }
 
-void table_col_translator(pugi::xml_node in, std::ostream &out,
+void table_col_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
   // TODO if min/max is unordered we have a problem here; fail fast in that case
 
@@ -230,6 +255,40 @@ void table_col_translator(pugi::xml_node in, std::ostream &out,
   const auto max = in.attribute("max").as_uint(1);
   const auto repeated = max - min + 1;
 
+  if (context.table_data != nullptr) {
+    const std::uint32_t span =
+        visible_span(context.table_cursor.col(), repeated,
+                     context.table_range.from().col(),
+                     context.table_range.to().col());
+    if (span > 0) {
+      common::HtmlWriter col_attributes;
+      element_attribute_translator(in, col_attributes, context);
+      context.table_data->add_column(
+          std::max(context.table_cursor.col(),
+                   context.table_range.from().col()),
+          span, col_attributes.str(), "");
+    }
+    context.table_cursor.add_col(repeated);
+    return;
+  }
+
+  if (context.config->table_compact) {
+    const std::uint32_t span =
+        visible_span(context.table_cursor.col(), repeated,
+                     context.table_range.from().col(),
+                     context.table_range.to().col());
+    if (span > 0) {
+      out << "<col";
+      element_attribute_translator(in, out, context);
+      if (span > 1) {
+        out << " span=\"" << span << "\"";
+      }
+      out << ">";
+    }
+    context.table_cursor.add_col(repeated);
+    return;
+  }
+
   for (std::uint32_t i = 0; i < repeated; ++i) {
     if (context.table_cursor.col() >= context.table_range.to().col()) {
       break;
@@ -243,9 +302,25 @@ void table_col_translator(pugi::xml_node in, std::ostream &out,
   }
 }
 
-void table_row_translator(pugi::xml_node in, std::ostream &out,
+void table_row_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                           Context &context) {
-  const auto row_index = in.attribute("r").as_uint() - 1;
+  // rows without a number follow the previous one
+  const std::uint32_t row_index =
+      common::TablePosition::parse_row(in.attribute("r").value())
+          .value_or(context.table_cursor.row());
+
+  if (((context.table_data != nullptr) || context.config->table_compact) &&
+      (row_index > context.table_cursor.row())) {
+    // empty rows collapse anyway; one of them is enough
+    if ((visible_span(context.table_cursor.row(),
+                     row_index - context.table_cursor.row(),
+                     context.table_range.from().row(),
+                     context.table_range.to().row()) > 0) &&
+        (context.table_data == nullptr)) {
+      out << "<tr></tr>";
+    }
+    context.table_cursor.add_row(row_index - context.table_cursor.row());
+  }
 
   while (row_index > context.table_cursor.row()) {
     if (context.table_cursor.row() >= context.table_range.to().row()) {
@@ -262,7 +337,14 @@ void table_row_translator(pugi::xml_node in, std::ostream &out,
   if (context.table_cursor.row() >= context.table_range.to().row()) {
     return;
   }
-  if (context.table_cursor.row() >= context.table_range.from().row()) {
+  if ((context.table_data != nullptr) &&
+      (context.table_cursor.row() >= context.table_range.from().row())) {
+    common::HtmlWriter row_attributes;
+    element_attribute_translator(in, row_attributes, context);
+    context.table_data->add_row(context.table_cursor.row(),
+                                row_attributes.str());
+    element_children_translator(in, out, context);
+  } else if (context.table_cursor.row() >= context.table_range.from().row()) {
     out << "<tr";
     element_attribute_translator(in, out, context);
     out << ">";
@@ -272,31 +354,19 @@ void table_row_translator(pugi::xml_node in, std::ostream &out,
   context.table_cursor.add_row();
 }
 
-void table_cell_translator(pugi::xml_node in, std::ostream &out,
-                           Context &context) {
-  const common::TablePosition cell_index(in.attribute("r").as_string());
-
-  while (cell_index.col() > context.table_cursor.col()) {
-    if (context.table_cursor.col() >= context.table_range.to().col()) {
-      return;
-    }
-    if (context.table_cursor.col() >= context.table_range.from().col()) {
-      out << "<td></td>";
-    }
-    context.table_cursor.add_cell();
-  }
-
-  out << "<td";
-  element_attribute_translator(in, out, context);
-  out << ">";
-
+void cell_content_translator(pugi::xml_node in, common::HtmlWriter &out,
+                             Context &context) {
   if (const auto t = in.attribute("t"); t) {
     if (std::strcmp(t.as_string(), "s") == 0) {
       const auto shared_string_index = in.child("v").text().as_int(-1);
-      if (shared_string_index >= 0) {
-        pugi::xml_node replacement =
-            context.shared_strings[shared_string_index];
-        element_children_translator(replacement, out, context);
+      const auto &shared_strings = context.shared->shared_strings;
+      const auto &nodes = context.shared->shared_string_nodes;
+      if ((shared_string_index >= 0) &&
+          (std::size_t(shared_string_index) < nodes.size())) {
+        element_children_translator(nodes[shared_string_index], out, context);
+      } else if ((shared_string_index >= 0) &&
+                 (std::size_t(shared_string_index) < shared_strings.size())) {
+        out.write(shared_strings[shared_string_index]);
       } else {
         DLOG(INFO) << "undefined behaviour: shared string not found";
       }
@@ -310,13 +380,70 @@ void table_cell_translator(pugi::xml_node in, std::ostream &out,
   } else {
     // TODO empty cell?
   }
+}
+
+void table_cell_translator(const pugi::xml_node &in, common::HtmlWriter &out,
+                           Context &context) {
+  // cells without a reference follow the previous one
+  const common::TablePosition cell_index =
+      common::TablePosition::parse(in.attribute("r").value())
+          .value_or(common::TablePosition(context.table_cursor.row(),
+                                          context.table_cursor.col()));
+
+  if (((context.table_data != nullptr) || context.config->table_compact) &&
+      (cell_index.col() > context.table_cursor.col())) {
+    const std::uint32_t span =
+        visible_span(context.table_cursor.col(),
+                     cell_index.col() - context.table_cursor.col(),
+                     context.table_range.from().col(),
+                     context.table_range.to().col());
+    // virtualized gaps are filled by the renderer
+    if (context.table_data == nullptr) {
+      if (span == 1) {
+        out << "<td></td>";
+      } else if (span > 1) {
+        out << "<td colspan=\"" << span << "\"></td>";
+      }
+    }
+    context.table_cursor.add_cell(cell_index.col() -
+                                  context.table_cursor.col());
+    if (context.table_cursor.col() >= context.table_range.to().col()) {
+      return;
+    }
+  }
 
-  out << "</td>";
+  while (cell_index.col() > context.table_cursor.col()) {
+    if (context.table_cursor.col() >= context.table_range.to().col()) {
+      return;
+    }
+    if (context.table_cursor.col() >= context.table_range.from().col()) {
+      out << "<td></td>";
+    }
+    context.table_cursor.add_cell();
+  }
+
+  if (context.table_data != nullptr) {
+    common::HtmlWriter cell_attributes;
+    element_attribute_translator(in, cell_attributes, context);
+    common::HtmlWriter content;
+    cell_content_translator(in, content, context);
+    if (!cell_attributes.str().empty() || !content.str().empty()) {
+      context.table_data->add_cell(context.table_cursor.row(),
+                                   context.table_cursor.col(), 1, 1,
+                                   cell_attributes.str(), content.str());
+    }
+  } else {
+    out << "<td";
+    element_attribute_translator(in, out, context);
+    out << ">";
+    cell_content_translator(in, out, context);
+    out << "</td>";
+  }
   context.table_cursor.add_cell();
 }
 
-void element_children_translator(pugi::xml_node in, std::ostream &out,
-                                 Context &context) {
+void element_children_translator(const pugi::xml_node &in,
+                                 common::HtmlWriter &out, Context &context) {
   for (auto &&n : in) {
     if (n.type() == pugi::node_pcdata) {
       text_translator(n, out, context);
@@ -326,41 +453,25 @@ void element_children_translator(pugi::xml_node in, std::ostream &out,
   }
 }
 
-void element_translator(pugi::xml_node in, std::ostream &out,
+using ElementDispatch = util::element::Dispatch<Context>;
+
+// sorted by element name
+constexpr util::map::StaticEntry<ElementDispatch::Handler> element_handlers[]{
+    {"c", ElementDispatch::translate(table_cell_translator)},
+    {"col", ElementDispatch::translate(table_col_translator)},
+    {"cols", ElementDispatch::substitute("colgroup")},
+    {"f", ElementDispatch::skip}, // TODO translate formula and hide
+    {"headerFooter", ElementDispatch::skip},
+    {"row", ElementDispatch::translate(table_row_translator)},
+    {"worksheet", ElementDispatch::translate(table_translator)},
+};
+static_assert(util::map::is_sorted(element_handlers));
+
+void element_translator(const pugi::xml_node &in, common::HtmlWriter &out,
                         Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
-      {"cols", "colgroup"},
-  };
-  static std::unordered_set<std::string> skippers{
-      "headerFooter",
-      "f", // TODO translate formula and hide
-  };
-
-  const std::string element = in.name();
-  if (skippers.find(element) != std::end(skippers)) {
-    return;
-  }
-
-  if (element == "worksheet") {
-    table_translator(in, out, context);
-  } else if (element == "col") {
-    table_col_translator(in, out, context);
-  } else if (element == "row") {
-    table_row_translator(in, out, context);
-  } else if (element == "c") {
-    table_cell_translator(in, out, context);
-  } else {
-    const auto it = substitution.find(element);
-    if (it != std::end(substitution)) {
-      out << "<" << it->second;
-      element_attribute_translator(in, out, context);
-      out << ">";
-    }
-    element_children_translator(in, out, context);
-    if (it != std::end(substitution)) {
-      out << "</" << it->second << ">";
-    }
-  }
+  ElementDispatch::element(element_handlers, in, out, context,
+                           element_attribute_translator,
+                           element_children_translator);
 }
 } // namespace
 
@@ -368,4 +479,16 @@ void workbook_translator::html(const pugi::xml_node &in, Context &context) {
   element_translator(in, *context.output, context);
 }
 
+void workbook_translator::shared_strings(const pugi::xml_node &in,
+                                         Context &context) {
+  SharedStrings &result = context.shared->shared_strings;
+  common::HtmlWriter out;
+  for (auto si = in.child("si"); si; si = si.next_sibling("si")) {
+    element_children_translator(si, out, context);
+    result.html += out.str();
+    result.offsets.push_back(result.html.size());
+    out.clear();
+  }
+}
+
 } // namespace odr::internal::ooxml
@@ -11,6 +11,8 @@ struct Context;
 namespace workbook_translator {
 void css(const pugi::xml_node &in, Context &context);
 void html(const pugi::xml_node &in, Context &context);
+// translates the `sst` of `xl/sharedStrings.xml` into the shared context
+void shared_strings(const pugi::xml_node &in, Context &context);
 } // namespace workbook_translator
 
 } // namespace odr::internal::ooxml
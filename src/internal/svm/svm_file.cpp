@@ -1,3 +1,4 @@
+#include <internal/common/file.h>
 #include <internal/svm/svm_file.h>
 #include <internal/svm/svm_format.h>
 #include <odr/file_meta.h>
@@ -5,9 +6,12 @@
 namespace odr::internal::svm {
 
 SvmFile::SvmFile(std::shared_ptr<abstract::File> file)
-    : m_file{std::move(file)} {
-  auto in = m_file->read();
-  read_header(*in);
+    : m_file{std::dynamic_pointer_cast<common::MemoryFile>(file)} {
+  if (!m_file) {
+    m_file = std::make_shared<common::MemoryFile>(*file);
+  }
+  Reader in(data());
+  read_header(in);
   // TODO store header?
 }
 
@@ -15,6 +19,8 @@ std::shared_ptr<abstract::File> SvmFile::file() const noexcept {
   return m_file;
 }
 
+std::string_view SvmFile::data() const { return m_file->content(); }
+
 FileType SvmFile::file_type() const noexcept {
   return FileType::STARVIEW_METAFILE;
 }
@@ -3,6 +3,11 @@
 
 #include <internal/abstract/file.h>
 #include <memory>
+#include <string_view>
+
+namespace odr::internal::common {
+class MemoryFile;
+} // namespace odr::internal::common
 
 namespace odr::internal::svm {
 
@@ -11,6 +16,8 @@ public:
   explicit SvmFile(std::shared_ptr<abstract::File> file);
 
   [[nodiscard]] std::shared_ptr<abstract::File> file() const noexcept;
+  // the whole metafile; decoded in place
+  [[nodiscard]] std::string_view data() const;
 
   [[nodiscard]] FileType file_type() const noexcept;
   [[nodiscard]] FileMeta file_meta() const noexcept;
@@ -18,7 +25,7 @@ public:
   [[nodiscard]] std::shared_ptr<abstract::Image> image() const;
 
 private:
-  std::shared_ptr<abstract::File> m_file;
+  std::shared_ptr<common::MemoryFile> m_file;
 };
 
 } // namespace odr::internal::svm
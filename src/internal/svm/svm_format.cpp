@@ -1,43 +1,60 @@
-#include <codecvt>
 #include <cstring>
 #include <glog/logging.h>
 #include <internal/svm/svm_format.h>
 #include <internal/util/string_util.h>
-#include <locale>
 #include <odr/exceptions.h>
 
 namespace odr::internal::svm {
-std::string read_ascii_string(std::istream &in, const std::uint32_t length) {
-  std::string result(length, ' ');
-  in.read(static_cast<char *>(result.data()), result.size());
+IntPair Points::Iterator::operator*() const noexcept {
+  IntPair result;
+  std::memcpy(&result.x, m_data, sizeof(result.x));
+  std::memcpy(&result.y, m_data + sizeof(result.x), sizeof(result.y));
+  return result;
+}
+
+const char *Reader::bytes(const std::size_t count) {
+  if (count > remaining()) {
+    throw MalformedSvmFile();
+  }
+  const char *result = m_current;
+  m_current += count;
   return result;
 }
 
-std::string read_utf16_string(std::istream &in, const std::uint32_t length) {
+Reader Reader::sub(const std::size_t count) {
+  const char *begin = bytes(count);
+  return Reader(begin, begin + count);
+}
+
+std::string read_ascii_string(Reader &in, const std::uint32_t length) {
+  return std::string(in.bytes(length), length);
+}
+
+std::string read_utf16_string(Reader &in, const std::uint32_t length) {
   std::u16string result_u16(length, ' ');
-  in.read(reinterpret_cast<char *>(result_u16.data()), length * 2);
+  std::memcpy(result_u16.data(), in.bytes(length * 2), length * 2);
   return util::string::u16string_to_string(result_u16);
 }
 
-std::string read_uint16_prefixed_ascii_string(std::istream &in) {
+std::string read_uint16_prefixed_ascii_string(Reader &in) {
   uint16_t length;
   read_primitive(in, length);
   return read_ascii_string(in, length);
 }
 
-std::string read_uint32_prefixed_utf16_string(std::istream &in) {
+std::string read_uint32_prefixed_utf16_string(Reader &in) {
   uint32_t length;
   read_primitive(in, length);
   return read_utf16_string(in, length);
 }
 
-std::string read_uint16_prefixed_utf16_string(std::istream &in) {
+std::string read_uint16_prefixed_utf16_string(Reader &in) {
   uint16_t length;
   read_primitive(in, length);
   return read_utf16_string(in, length);
 }
 
-std::string read_string_with_encoding(std::istream &in,
+std::string read_string_with_encoding(Reader &in,
                                       const TextEncoding encoding) {
   if (encoding == RTL_TEXTENCODING_UCS2) {
     return read_uint32_prefixed_utf16_string(in);
@@ -45,7 +62,7 @@ std::string read_string_with_encoding(std::istream &in,
   return read_uint16_prefixed_ascii_string(in);
 }
 
-VersionLength read_version_length(std::istream &in) {
+VersionLength read_version_length(Reader &in) {
   VersionLength result;
   read_primitive(in, result.version);
   read_primitive(in, result.length);
@@ -55,14 +72,14 @@ VersionLength read_version_length(std::istream &in) {
   return result;
 }
 
-IntPair read_int_pair(std::istream &in) {
+IntPair read_int_pair(Reader &in) {
   IntPair result;
   read_primitive(in, result.x);
   read_primitive(in, result.y);
   return result;
 }
 
-Rectangle read_rectangle(std::istream &in) {
+Rectangle read_rectangle(Reader &in) {
   Rectangle result;
   read_primitive(in, result.left);
   read_primitive(in, result.top);
@@ -71,22 +88,15 @@ Rectangle read_rectangle(std::istream &in) {
   return result;
 }
 
-std::vector<IntPair> read_polygon(std::istream &in) {
-  std::vector<IntPair> result;
-
+Points read_polygon(Reader &in) {
   std::uint16_t size;
   read_primitive(in, size);
 
-  result.resize(size);
-  for (auto &&p : result) {
-    p = read_int_pair(in);
-  }
-
-  return result;
+  return Points(in.bytes(size * Points::point_size), size);
 }
 
-std::vector<std::vector<IntPair>> read_poly_polygon(std::istream &in) {
-  std::vector<std::vector<IntPair>> result;
+std::vector<Points> read_poly_polygon(Reader &in) {
+  std::vector<Points> result;
 
   std::uint16_t size;
   read_primitive(in, size);
@@ -99,19 +109,18 @@ std::vector<std::vector<IntPair>> read_poly_polygon(std::istream &in) {
   return result;
 }
 
-Header read_header(std::istream &in) {
+Header read_header(Reader &in) {
   Header result;
 
-  char magic[6];
-  std::cout << in.tellg() << std::endl;
-  in.read(magic, sizeof(magic));
-  if (std::strncmp("VCLMTF", magic, sizeof(magic)) != 0) {
+  constexpr std::string_view magic = "VCLMTF";
+  if ((in.remaining() < magic.size()) ||
+      (std::string_view(in.bytes(magic.size()), magic.size()) != magic)) {
     throw NoSvmFile();
   }
 
   result.vl = read_version_length(in);
 
-  std::size_t start = in.tellg();
+  const std::size_t start = in.position();
   read_primitive(in, result.compression_mode);
   result.map_mode = read_map_mode(in);
   result.size = read_int_pair(in);
@@ -121,16 +130,17 @@ Header read_header(std::istream &in) {
     read_primitive(in, result.render_graphic_replacements);
   }
 
-  const std::size_t left = result.vl.length - ((std::size_t)in.tellg() - start);
-  if (left > 0) {
+  const std::size_t read = in.position() - start;
+  if (read < result.vl.length) {
+    const std::size_t left = result.vl.length - read;
     DLOG(WARNING) << "Header skipping " << left << " bytes";
-    in.ignore(left);
+    in.skip(left);
   }
 
   return result;
 }
 
-ActionHeader read_action_header(std::istream &in) {
+ActionHeader read_action_header(Reader &in) {
   ActionHeader result;
 
   read_primitive(in, result.type);
@@ -139,7 +149,7 @@ ActionHeader read_action_header(std::istream &in) {
   return result;
 }
 
-MapMode read_map_mode(std::istream &in) {
+MapMode read_map_mode(Reader &in) {
   MapMode result;
 
   VersionLength vl = read_version_length(in);
@@ -153,7 +163,7 @@ MapMode read_map_mode(std::istream &in) {
   return result;
 }
 
-LineInfo read_line_info(std::istream &in) {
+LineInfo read_line_info(Reader &in) {
   LineInfo result;
 
   VersionLength vl = read_version_length(in);
@@ -181,7 +191,7 @@ LineInfo read_line_info(std::istream &in) {
   return result;
 }
 
-Font read_font(std::istream &in) {
+Font read_font(Reader &in) {
   Font result;
 
   result.vl = read_version_length(in);
@@ -217,8 +227,7 @@ Font read_font(std::istream &in) {
   return result;
 }
 
-PolyLineAction read_poly_line_action(std::istream &in,
-                                     const VersionLength &vl) {
+PolyLineAction read_poly_line_action(Reader &in, const VersionLength &vl) {
   PolyLineAction result;
 
   result.points = read_polygon(in);
@@ -240,7 +249,7 @@ PolyLineAction read_poly_line_action(std::istream &in,
   return result;
 }
 
-PolygonAction read_polygon_action(std::istream &in, const VersionLength &vl) {
+PolygonAction read_polygon_action(Reader &in, const VersionLength &vl) {
   PolygonAction result;
 
   result.points = read_polygon(in);
@@ -258,7 +267,7 @@ PolygonAction read_polygon_action(std::istream &in, const VersionLength &vl) {
   return result;
 }
 
-PolyPolygonAction read_poly_polygon_action(std::istream &in,
+PolyPolygonAction read_poly_polygon_action(Reader &in,
                                            const VersionLength &vl) {
   PolyPolygonAction result;
 
@@ -277,7 +286,7 @@ PolyPolygonAction read_poly_polygon_action(std::istream &in,
   return result;
 }
 
-TextAction read_text_action(std::istream &in, const VersionLength &vl,
+TextAction read_text_action(Reader &in, const VersionLength &vl,
                             const TextEncoding encoding) {
   TextAction result;
 
@@ -293,8 +302,7 @@ TextAction read_text_action(std::istream &in, const VersionLength &vl,
   return result;
 }
 
-TextArrayAction read_text_array_action(std::istream &in,
-                                       const VersionLength &vl,
+TextArrayAction read_text_array_action(Reader &in, const VersionLength &vl,
                                        const TextEncoding encoding) {
   TextArrayAction result;
 
@@ -316,7 +324,7 @@ TextArrayAction read_text_array_action(std::istream &in,
   return result;
 }
 
-StretchTextAction read_stretch_text_action(std::istream &in,
+StretchTextAction read_stretch_text_action(Reader &in,
                                            const VersionLength &vl,
                                            const TextEncoding encoding) {
   StretchTextAction result;
@@ -334,7 +342,7 @@ StretchTextAction read_stretch_text_action(std::istream &in,
   return result;
 }
 
-TextRectangleAction read_text_rectangle_action(std::istream &in,
+TextRectangleAction read_text_rectangle_action(Reader &in,
                                                const VersionLength &vl,
                                                const TextEncoding encoding) {
   TextRectangleAction result;
@@ -350,8 +358,7 @@ TextRectangleAction read_text_rectangle_action(std::istream &in,
   return result;
 }
 
-TextLineAction read_text_line_action(std::istream &in,
-                                     const VersionLength &vl) {
+TextLineAction read_text_line_action(Reader &in, const VersionLength &vl) {
   TextLineAction result;
 
   result.position = read_int_pair(in);
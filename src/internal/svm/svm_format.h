@@ -1,9 +1,13 @@
 #ifndef ODR_INTERNAL_SVM_FORMAT_H
 #define ODR_INTERNAL_SVM_FORMAT_H
 
+#include <cstddef>
 #include <cstdint>
-#include <iostream>
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 // https://github.com/LibreOffice/core/blob/master/include/vcl/metaact.hxx
@@ -83,6 +87,57 @@ struct IntPair final {
   std::int32_t y{};
 };
 
+// points stored in place inside of the metafile
+class Points final {
+public:
+  static constexpr std::size_t point_size = 8;
+
+  class Iterator final {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = IntPair;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = IntPair;
+
+    explicit Iterator(const char *data) noexcept : m_data{data} {}
+
+    IntPair operator*() const noexcept;
+    Iterator &operator++() noexcept {
+      m_data += point_size;
+      return *this;
+    }
+    bool operator==(const Iterator &rhs) const noexcept {
+      return m_data == rhs.m_data;
+    }
+    bool operator!=(const Iterator &rhs) const noexcept {
+      return m_data != rhs.m_data;
+    }
+
+  private:
+    const char *m_data;
+  };
+
+  Points() noexcept = default;
+  Points(const char *data, std::size_t size) noexcept
+      : m_data{data}, m_size{size} {}
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] IntPair operator[](std::size_t i) const noexcept {
+    return *Iterator(m_data + i * point_size);
+  }
+
+  [[nodiscard]] Iterator begin() const noexcept { return Iterator(m_data); }
+  [[nodiscard]] Iterator end() const noexcept {
+    return Iterator(m_data + m_size * point_size);
+  }
+
+private:
+  const char *m_data{nullptr};
+  std::size_t m_size{0};
+};
+
 struct Rectangle final {
   std::int32_t left{};
   std::int32_t top{};
@@ -156,16 +211,16 @@ struct ActionHeader final {
 };
 
 struct PolyLineAction final {
-  std::vector<IntPair> points;
+  Points points;
   LineInfo line_info;
 };
 
 struct PolygonAction final {
-  std::vector<IntPair> points;
+  Points points;
 };
 
 struct PolyPolygonAction final {
-  std::vector<std::vector<IntPair>> polygons;
+  std::vector<Points> polygons;
 };
 
 struct TextAction final {
@@ -205,44 +260,75 @@ struct TextLineAction final {
   std::uint32_t overline{};
 };
 
-template <typename T> void read_primitive(std::istream &in, T &out) {
-  in.read(reinterpret_cast<char *>(&out), sizeof(out));
-}
-
-std::string read_ascii_string(std::istream &in, std::uint32_t length);
-std::string read_utf16_string(std::istream &in, std::uint32_t length);
-std::string read_uint16_prefixed_ascii_string(std::istream &in);
-std::string read_uint32_prefixed_utf16_string(std::istream &in);
-std::string read_uint16_prefixed_utf16_string(std::istream &in);
-std::string read_string_with_encoding(std::istream &in, TextEncoding encoding);
-
-VersionLength read_version_length(std::istream &in);
-IntPair read_int_pair(std::istream &in);
-Rectangle read_rectangle(std::istream &in);
-std::vector<IntPair> read_polygon(std::istream &in);
-std::vector<std::vector<IntPair>> read_poly_polygon(std::istream &in);
-
-Header read_header(std::istream &in);
-ActionHeader read_action_header(std::istream &in);
-MapMode read_map_mode(std::istream &in);
-LineInfo read_line_info(std::istream &in);
-Font read_font(std::istream &in);
-PolyLineAction read_poly_line_action(std::istream &in, const VersionLength &vl);
-PolygonAction read_polygon_action(std::istream &in, const VersionLength &vl);
-PolyPolygonAction read_poly_polygon_action(std::istream &in,
+// bounds checked cursor over the little endian bytes of a metafile; throws
+// `MalformedSvmFile` instead of reading past the end. the views handed out
+// point into the underlying bytes
+class Reader final {
+public:
+  Reader(const char *begin, const char *end) noexcept
+      : m_begin{begin}, m_current{begin}, m_end{end} {}
+  explicit Reader(std::string_view data) noexcept
+      : Reader(data.data(), data.data() + data.size()) {}
+
+  [[nodiscard]] std::size_t position() const noexcept {
+    return m_current - m_begin;
+  }
+  [[nodiscard]] std::size_t remaining() const noexcept {
+    return m_end - m_current;
+  }
+  [[nodiscard]] bool end() const noexcept { return m_current == m_end; }
+
+  template <typename T> void read(T &out) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::memcpy(&out, bytes(sizeof(T)), sizeof(T));
+  }
+  // `count` bytes; advances the cursor
+  const char *bytes(std::size_t count);
+  void skip(std::size_t count) { bytes(count); }
+  // the next `count` bytes as separate reader; advances the cursor
+  Reader sub(std::size_t count);
+
+private:
+  const char *m_begin;
+  const char *m_current;
+  const char *m_end;
+};
+
+template <typename T> void read_primitive(Reader &in, T &out) { in.read(out); }
+
+std::string read_ascii_string(Reader &in, std::uint32_t length);
+std::string read_utf16_string(Reader &in, std::uint32_t length);
+std::string read_uint16_prefixed_ascii_string(Reader &in);
+std::string read_uint32_prefixed_utf16_string(Reader &in);
+std::string read_uint16_prefixed_utf16_string(Reader &in);
+std::string read_string_with_encoding(Reader &in, TextEncoding encoding);
+
+VersionLength read_version_length(Reader &in);
+IntPair read_int_pair(Reader &in);
+Rectangle read_rectangle(Reader &in);
+Points read_polygon(Reader &in);
+std::vector<Points> read_poly_polygon(Reader &in);
+
+Header read_header(Reader &in);
+ActionHeader read_action_header(Reader &in);
+MapMode read_map_mode(Reader &in);
+LineInfo read_line_info(Reader &in);
+Font read_font(Reader &in);
+PolyLineAction read_poly_line_action(Reader &in, const VersionLength &vl);
+PolygonAction read_polygon_action(Reader &in, const VersionLength &vl);
+PolyPolygonAction read_poly_polygon_action(Reader &in,
                                            const VersionLength &vl);
-TextAction read_text_action(std::istream &in, const VersionLength &vl,
+TextAction read_text_action(Reader &in, const VersionLength &vl,
                             TextEncoding encoding);
-TextArrayAction read_text_array_action(std::istream &in,
-                                       const VersionLength &vl,
+TextArrayAction read_text_array_action(Reader &in, const VersionLength &vl,
                                        TextEncoding encoding);
-StretchTextAction read_stretch_text_action(std::istream &in,
+StretchTextAction read_stretch_text_action(Reader &in,
                                            const VersionLength &vl,
                                            TextEncoding encoding);
-TextRectangleAction read_text_rectangle_action(std::istream &in,
+TextRectangleAction read_text_rectangle_action(Reader &in,
                                                const VersionLength &vl,
                                                TextEncoding encoding);
-TextLineAction read_text_line_action(std::istream &in, const VersionLength &vl);
+TextLineAction read_text_line_action(Reader &in, const VersionLength &vl);
 
 } // namespace odr::internal::svm
 
@@ -1,17 +1,58 @@
+#include <algorithm>
+#include <cmath>
 #include <glog/logging.h>
+#include <internal/common/file.h>
+#include <internal/common/html_writer.h>
+#include <internal/common/lru_cache.h>
+#include <internal/crypto/crypto_util.h>
 #include <internal/svm/svm_file.h>
 #include <internal/svm/svm_format.h>
 #include <internal/svm/svm_to_svg.h>
+#include <limits>
 #include <odr/exceptions.h>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace odr::internal::svm {
 
 namespace {
+// bounding box of the shapes of a path; empty by default
+struct Bounds final {
+  std::int64_t left{std::numeric_limits<std::int64_t>::max()};
+  std::int64_t top{std::numeric_limits<std::int64_t>::max()};
+  std::int64_t right{std::numeric_limits<std::int64_t>::min()};
+  std::int64_t bottom{std::numeric_limits<std::int64_t>::min()};
+
+  // true if the interiors intersect
+  [[nodiscard]] bool overlaps(const Bounds &other) const noexcept {
+    return (left < other.right) && (other.left < right) &&
+           (top < other.bottom) && (other.top < bottom);
+  }
+
+  void extend(const std::int64_t x, const std::int64_t y) noexcept {
+    left = std::min(left, x);
+    top = std::min(top, y);
+    right = std::max(right, x);
+    bottom = std::max(bottom, y);
+  }
+
+  void extend(const Bounds &other) noexcept {
+    extend(other.left, other.top);
+    extend(other.right, other.bottom);
+  }
+};
+
+// converted metafiles by the sha256 of their content
+common::LruCache<std::string, std::string> &svg_cache() {
+  static common::LruCache<std::string, std::string> cache(32 * 1024 * 1024);
+  return cache;
+}
+
 struct Context final {
-  std::istream *in{};
-  std::ostream *out{};
+  Reader *in{};
+  common::HtmlWriter *out{};
   const ActionHeader *action{};
 
   // MapMode map_mode;
@@ -26,107 +67,250 @@ struct Context final {
   std::uint32_t text_rgb{};
   std::uint32_t text_fill_rgb{};
   bool text_fill_rgb_set{};
+
+  // points closer than this to the simplified outline are dropped
+  double tolerance{0};
+  // styles become classes `s<index>` in order of appearance
+  std::unordered_map<std::string, std::size_t> style_classes;
+  std::vector<const std::string *> styles;
+  // consecutive shapes of the same style are collected into one path
+  std::size_t path_class{0};
+  Bounds path_bounds;
+  common::HtmlWriter path;
 };
 
-std::string get_svg_color_string(const std::uint32_t color) {
-  const uint8_t blue = (color >> 0) & 0xff;
-  const uint8_t green = (color >> 8) & 0xff;
-  const uint8_t red = (color >> 16) & 0xff;
-  return "rgb(" + std::to_string(red) + "," + std::to_string(green) + "," +
-         std::to_string(blue) + ")";
+// the output is assumed to be at most this wide or high; half a pixel at
+// that size is the tolerance of the simplification
+constexpr double max_output_size = 2048;
+
+void write_svg_color(common::HtmlWriter &out, const std::uint32_t color) {
+  const std::uint32_t blue = (color >> 0) & 0xff;
+  const std::uint32_t green = (color >> 8) & 0xff;
+  const std::uint32_t red = (color >> 16) & 0xff;
+  out << "rgb(" << red << "," << green << "," << blue << ")";
 }
 
-void write_color_style(std::ostream &out, const std::string &prefix,
+void write_color_style(common::HtmlWriter &out, const char *prefix,
                        const std::uint32_t color, const bool set) {
   if (set) {
-    out << prefix << ":" << get_svg_color_string(color);
+    out << prefix << ":";
+    write_svg_color(out, color);
   } else {
     out << prefix << "-opacity:0";
   }
   out << ";";
 }
 
-void write_line_style(std::ostream &out, Context &context) {
+void write_line_style(common::HtmlWriter &out, Context &context) {
   write_color_style(out, "stroke", context.line_rgb, context.line_rgb_set);
   out << "vector-effect:non-scaling-stroke;";
   out << "fill:none;";
 }
 
-void write_fill_style(std::ostream &out, Context &context) {
+void write_fill_style(common::HtmlWriter &out, Context &context) {
   write_color_style(out, "fill", context.fill_rgb, context.fill_rgb_set);
   out << "stroke:none;";
 }
 
-void write_text_style(std::ostream &out, Context &context) {
+void write_text_style(common::HtmlWriter &out, Context &context) {
   write_color_style(out, "fill", context.text_rgb, true);
   out << "font-family:" << context.font.family_name << ";";
   out << "font-size:" << context.font.size.y << ";";
 }
 
-void write_style(std::ostream &out, Context &context, const int styles) {
-  out << " style=\"";
+// index of the class holding the current style
+std::size_t style_class(Context &context, const int styles) {
+  common::HtmlWriter style;
   switch (styles) {
   case 0:
-    write_line_style(out, context);
+    write_line_style(style, context);
     break;
   case 1:
-    write_line_style(out, context);
-    write_fill_style(out, context);
+    write_line_style(style, context);
+    write_fill_style(style, context);
     break;
   case 2:
-    write_text_style(out, context);
+    write_text_style(style, context);
     break;
   default:
     DLOG(WARNING) << "not implemented";
   }
-  out << "\"";
+
+  const auto [it, inserted] =
+      context.style_classes.emplace(style.str(), context.styles.size());
+  if (inserted) {
+    context.styles.push_back(&it->first);
+  }
+  return it->second;
 }
 
-void write_rectangle(std::ostream &out, const Rectangle &rect,
-                     Context &context) {
-  out << "<rect";
-  out << " x=\"" << rect.left << "\"";
-  out << " y=\"" << rect.top << "\"";
-  out << " width=\"" << (rect.right - rect.left) << "\"";
-  out << " height=\"" << (rect.bottom - rect.top) << "\"";
-  write_style(out, context, 1);
-  out << " />";
+void flush_path(Context &context) {
+  context.path_bounds = Bounds();
+  if (context.path.str().empty()) {
+    return;
+  }
+  *context.out << "<path class=\"s" << context.path_class << "\" d=\""
+               << context.path.str() << "\"/>";
+  context.path.clear();
 }
 
-void write_polygon(std::ostream &out, const std::string &tag,
-                   const std::vector<IntPair> &points, const bool fill,
-                   Context &context) {
-  out << "<" << tag;
+// continues the current path if the style did not change. the line style
+// only strokes and the fill style only fills, both with opaque colors, so a
+// merged path paints the union of its shapes. fills are only merged if they
+// do not overlap; otherwise the winding of self-intersecting shapes could
+// cancel out under the `nonzero` rule
+common::HtmlWriter &begin_path(Context &context, const int styles,
+                               const Bounds &bounds) {
+  const std::size_t path_class = style_class(context, styles);
+  const bool fill = styles != 0;
+  if ((path_class != context.path_class) ||
+      (fill && context.path_bounds.overlaps(bounds))) {
+    flush_path(context);
+    context.path_class = path_class;
+  }
+  context.path_bounds.extend(bounds);
+  return context.path;
+}
 
-  out << " points=\"";
-  for (auto &&p : points) {
-    out << p.x << "," << p.y;
-    out << " ";
+void write_coordinate(common::HtmlWriter &out, const std::int64_t value) {
+  if (value >= 0) {
+    out << ' ';
   }
-  out << "\"";
+  out << value;
+}
 
-  if (fill) {
-    write_style(out, context, 1);
-  } else {
-    write_style(out, context, 0);
+double segment_distance(const IntPair &p, const IntPair &a, const IntPair &b) {
+  const double dx = double(b.x) - a.x;
+  const double dy = double(b.y) - a.y;
+  const double length = dx * dx + dy * dy;
+  double t = 0;
+  if (length > 0) {
+    t = std::clamp(((double(p.x) - a.x) * dx + (double(p.y) - a.y) * dy) /
+                       length,
+                   0.0, 1.0);
+  }
+  return std::hypot(a.x + t * dx - p.x, a.y + t * dy - p.y);
+}
+
+// Douglas-Peucker; the first and the last point are always kept
+std::vector<bool> simplify(const Points &points, const double tolerance) {
+  std::vector<bool> keep(points.size(), tolerance <= 0);
+  if (points.empty() || (tolerance <= 0)) {
+    return keep;
+  }
+  keep.front() = true;
+  keep.back() = true;
+
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  ranges.emplace_back(0, points.size() - 1);
+  while (!ranges.empty()) {
+    const auto [first, last] = ranges.back();
+    ranges.pop_back();
+
+    double max_distance = 0;
+    std::size_t max_index = first;
+    for (std::size_t i = first + 1; i < last; ++i) {
+      const double distance =
+          segment_distance(points[i], points[first], points[last]);
+      if (distance > max_distance) {
+        max_distance = distance;
+        max_index = i;
+      }
+    }
+
+    if (max_distance > tolerance) {
+      keep[max_index] = true;
+      ranges.emplace_back(first, max_index);
+      ranges.emplace_back(max_index, last);
+    }
+  }
+
+  return keep;
+}
+
+// appends the points as relative subpath
+void write_subpath(common::HtmlWriter &path, const Points &points,
+                   const bool close, const Context &context) {
+  if (points.empty()) {
+    return;
+  }
+
+  const std::vector<bool> keep = simplify(points, context.tolerance);
+
+  IntPair last{};
+  bool first = true;
+  bool line = false;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (!keep[i]) {
+      continue;
+    }
+    const IntPair p = points[i];
+    if (first) {
+      path << 'M';
+      write_coordinate(path, p.x);
+      write_coordinate(path, p.y);
+      first = false;
+    } else if ((p.x != last.x) || (p.y != last.y)) {
+      if (!line) {
+        path << 'l';
+        line = true;
+      }
+      write_coordinate(path, std::int64_t(p.x) - last.x);
+      write_coordinate(path, std::int64_t(p.y) - last.y);
+    }
+    last = p;
   }
+  if (close) {
+    path << 'z';
+  }
+}
 
-  out << " />";
+void write_rectangle(common::HtmlWriter &, const Rectangle &rect,
+                     Context &context) {
+  const std::int32_t left = std::min(rect.left, rect.right);
+  const std::int32_t top = std::min(rect.top, rect.bottom);
+  const std::int64_t width = std::abs(std::int64_t(rect.right) - rect.left);
+  const std::int64_t height = std::abs(std::int64_t(rect.bottom) - rect.top);
+  Bounds bounds;
+  bounds.extend(left, top);
+  bounds.extend(left + width, top + height);
+  common::HtmlWriter &path = begin_path(context, 1, bounds);
+  path << 'M';
+  write_coordinate(path, left);
+  write_coordinate(path, top);
+  path << 'h';
+  write_coordinate(path, width);
+  path << 'v';
+  write_coordinate(path, height);
+  path << 'h';
+  write_coordinate(path, -width);
+  path << 'z';
+}
+
+void write_polygon(common::HtmlWriter &, const std::string &tag,
+                   const Points &points, const bool fill, Context &context) {
+  Bounds bounds;
+  for (const IntPair p : points) {
+    bounds.extend(p.x, p.y);
+  }
+  common::HtmlWriter &path = begin_path(context, fill ? 1 : 0, bounds);
+  write_subpath(path, points, tag == "polygon", context);
 }
 
-void write_text(std::ostream &out, const IntPair &point,
+void write_text(common::HtmlWriter &out, const IntPair &point,
                 const std::string &text, Context &context) {
+  flush_path(context);
   out << "<text";
+  out << " class=\"s" << style_class(context, 2) << "\"";
   out << " x=\"" << point.x << "\"";
   out << " y=\"" << point.y << "\"";
-  write_style(out, context, 2);
   out << ">";
   out << text;
   out << "</text>";
 }
 
-void translate_action(const ActionHeader &action_header, std::istream &in,
-                      std::ostream &out, Context &context) {
+void translate_action(const ActionHeader &action_header, Reader &in,
+                      common::HtmlWriter &out, Context &context) {
   switch (action_header.type) {
   case META_FILLCOLOR_ACTION:
     read_primitive(in, context.fill_rgb);
@@ -197,59 +381,82 @@ void translate_action(const ActionHeader &action_header, std::istream &in,
   case META_POP_ACTION:
   case META_TEXTLANGUAGE_ACTION:
   case META_COMMENT_ACTION:
-    in.ignore(action_header.vl.length);
     break;
   default:
     DLOG(WARNING) << "unhandled action_header " << action_header.type
                   << " version " << action_header.vl.version << " length "
                   << action_header.vl.length;
-    in.ignore(action_header.vl.length);
     break;
   }
 }
 } // namespace
 
-void Translator::svg(const SvmFile &file, std::ostream &out) {
-  auto istream = file.file()->read();
-  auto &in = *istream;
+void Translator::svg(const SvmFile &file, common::HtmlWriter &out) {
+  Reader in(file.data());
+
+  // the shapes are written first to know the styles
+  common::HtmlWriter body;
 
   Context context;
   context.in = &in;
-  context.out = &out;
+  context.out = &body;
 
   Header header = read_header(in);
 
   context.encoding = RTL_TEXTENCODING_ASCII_US;
   // context.map_mode = header.map_mode;
+  context.tolerance =
+      0.5 * std::max(std::abs(header.size.x), std::abs(header.size.y)) /
+      max_output_size;
 
-  out << "<svg";
-  out << " xmlns=\"http://www.w3.org/2000/svg\"";
-  out << " version=\"1.1\"";
-  out << " viewBox=\"0 0 " << header.size.x << " " << header.size.y << "\"";
-  out << ">";
-
-  while (in.peek() != -1) {
-    // TODO check length fields should never exceed file size (limited istream?)
-    ActionHeader action_header = read_action_header(in);
-    std::int64_t start = in.tellg();
+  while (!in.end()) {
+    const ActionHeader action_header = read_action_header(in);
+    // actions reading more than their length are malformed; the rest of the
+    // action is skipped
+    Reader action = in.sub(action_header.vl.length);
 
-    translate_action(action_header, in, out, context);
+    translate_action(action_header, action, body, context);
 
-    const std::int64_t left =
-        action_header.vl.length - ((std::int64_t)in.tellg() - start);
-    if (left > 0) {
-      DLOG(WARNING) << "skipping " << left << " bytes of action "
+    if (!action.end()) {
+      DLOG(WARNING) << "skipping " << action.remaining() << " bytes of action "
                     << action_header.type << " version "
                     << action_header.vl.version;
-      in.ignore(left);
-    } else if (left < 0) {
-      LOG(ERROR) << -left << " bytes missing action " << action_header.type
-                 << " version " << action_header.vl.version;
-      throw MalformedSvmFile();
     }
   }
+  flush_path(context);
 
+  out << "<svg";
+  out << " xmlns=\"http://www.w3.org/2000/svg\"";
+  out << " version=\"1.1\"";
+  out << " viewBox=\"0 0 " << header.size.x << " " << header.size.y << "\"";
+  out << ">";
+  if (!context.styles.empty()) {
+    out << "<style>";
+    for (std::size_t i = 0; i < context.styles.size(); ++i) {
+      out << ".s" << i << "{" << *context.styles[i] << "}";
+    }
+    out << "</style>";
+  }
+  out << body.str();
   out << "</svg>";
 }
 
+std::shared_ptr<const std::string> Translator::svg(std::string data) {
+  const std::string hash = crypto::util::sha256(data);
+  if (auto result = svg_cache().find(hash)) {
+    return result;
+  }
+
+  const SvmFile file(std::make_shared<common::MemoryFile>(std::move(data)));
+  common::HtmlWriter out;
+  svg(file, out);
+  std::string result = out.str();
+  const std::size_t cost = result.size();
+  return svg_cache().insert(hash, std::move(result), cost);
+}
+
+void Translator::svg_cache_budget(const std::size_t budget) {
+  svg_cache().budget(budget);
+}
+
 } // namespace odr::internal::svm
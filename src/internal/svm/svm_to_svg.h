@@ -1,15 +1,25 @@
 #ifndef ODR_INTERNAL_SVM_TO_SVG_H
 #define ODR_INTERNAL_SVM_TO_SVG_H
 
-#include <iostream>
+#include <cstddef>
 #include <memory>
+#include <string>
+
+namespace odr::internal::common {
+class HtmlWriter;
+}
 
 namespace odr::internal::svm {
 class SvmFile;
 
 namespace Translator {
-void svg(const SvmFile &file, std::ostream &out);
-}
+void svg(const SvmFile &file, common::HtmlWriter &out);
+// converts the metafile `data`; the results are cached by content for the
+// whole process and are shared between documents
+std::shared_ptr<const std::string> svg(std::string data);
+// memory budget of the conversion cache in bytes
+void svg_cache_budget(std::size_t budget);
+} // namespace Translator
 } // namespace odr::internal::svm
 
 #endif // ODR_INTERNAL_SVM_TO_SVG_H
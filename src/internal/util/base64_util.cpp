@@ -0,0 +1,107 @@
+#include <cstdint>
+#include <cstring>
+#include <internal/util/base64_util.h>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace odr::internal::util {
+
+namespace {
+constexpr char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// encodings of all 12 bit values; two output chars per lookup
+struct PairTable {
+  char pairs[4096][2];
+
+  constexpr PairTable() : pairs{} {
+    for (std::size_t i = 0; i < 4096; ++i) {
+      pairs[i][0] = alphabet[i >> 6];
+      pairs[i][1] = alphabet[i & 0x3f];
+    }
+  }
+};
+
+constexpr PairTable pair_table;
+
+#ifdef __SSSE3__
+// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+// 12 bytes per step but 16 bytes are loaded; the caller keeps the rest
+const char *encode_ssse3(const char *begin, const char *end,
+                         char *&out) noexcept {
+  const __m128i shuffle =
+      _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  const __m128i offsets =
+      _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  while (end - begin >= 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    in = _mm_shuffle_epi8(in, shuffle);
+
+    // split the 24 bit groups into four 6 bit indices per 32 bit lane
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // map the indices to the ranges of the alphabet and add their offsets
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    const __m128i result =
+        _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), result);
+    begin += 12;
+    out += 16;
+  }
+  return begin;
+}
+#endif
+} // namespace
+
+char *base64::encode(const char *begin, const char *end, char *out) noexcept {
+#ifdef __SSSE3__
+  begin = encode_ssse3(begin, end, out);
+#endif
+
+  for (; end - begin >= 3; begin += 3) {
+    const std::uint32_t group = (std::uint32_t(std::uint8_t(begin[0])) << 16) |
+                                (std::uint32_t(std::uint8_t(begin[1])) << 8) |
+                                std::uint32_t(std::uint8_t(begin[2]));
+    std::memcpy(out, pair_table.pairs[group >> 12], 2);
+    std::memcpy(out + 2, pair_table.pairs[group & 0xfff], 2);
+    out += 4;
+  }
+
+  if (end - begin == 1) {
+    const auto byte = std::uint8_t(begin[0]);
+    out[0] = alphabet[byte >> 2];
+    out[1] = alphabet[(byte & 0x03) << 4];
+    out[2] = '=';
+    out[3] = '=';
+    out += 4;
+  } else if (end - begin == 2) {
+    const auto byte0 = std::uint8_t(begin[0]);
+    const auto byte1 = std::uint8_t(begin[1]);
+    out[0] = alphabet[byte0 >> 2];
+    out[1] = alphabet[((byte0 & 0x03) << 4) | (byte1 >> 4)];
+    out[2] = alphabet[(byte1 & 0x0f) << 2];
+    out[3] = '=';
+    out += 4;
+  }
+
+  return out;
+}
+
+std::string base64::encode(const std::string_view data) {
+  std::string result(encoded_length(data.size()), '\0');
+  encode(data.data(), data.data() + data.size(), result.data());
+  return result;
+}
+
+} // namespace odr::internal::util
@@ -0,0 +1,21 @@
+#ifndef ODR_INTERNAL_UTIL_BASE64_H
+#define ODR_INTERNAL_UTIL_BASE64_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace odr::internal::util::base64 {
+// length of the padded encoding of `length` bytes
+constexpr std::size_t encoded_length(const std::size_t length) noexcept {
+  return (length + 2) / 3 * 4;
+}
+
+// encodes `[begin, end)` to `out` which has to hold `encoded_length` chars;
+// only the last group is padded so inputs can be split at multiples of three.
+// returns the end of the output
+char *encode(const char *begin, const char *end, char *out) noexcept;
+std::string encode(std::string_view data);
+} // namespace odr::internal::util::base64
+
+#endif // ODR_INTERNAL_UTIL_BASE64_H
@@ -0,0 +1,71 @@
+#ifndef ODR_INTERNAL_UTIL_ELEMENT_H
+#define ODR_INTERNAL_UTIL_ELEMENT_H
+
+#include <cstddef>
+#include <internal/common/html_writer.h>
+#include <internal/util/map_util.h>
+#include <pugixml.hpp>
+
+namespace odr::internal::util::element {
+enum class Type {
+  SKIP,
+  SUBSTITUTE,
+  TRANSLATE,
+};
+
+// translation of xml elements to html by a static table of handlers sorted by
+// element name; shared by the translators which differ in their `Context`
+template <typename Context> class Dispatch final {
+public:
+  using Translator = void (*)(const pugi::xml_node &, common::HtmlWriter &,
+                              Context &);
+
+  struct Handler {
+    Type type;
+    Translator translator;
+    const char *tag;
+  };
+
+  static constexpr Handler skip{Type::SKIP, nullptr, nullptr};
+
+  static constexpr Handler substitute(const char *tag) {
+    return {Type::SUBSTITUTE, nullptr, tag};
+  }
+
+  static constexpr Handler translate(Translator translator) {
+    return {Type::TRANSLATE, translator, nullptr};
+  }
+
+  // unknown elements only translate their children; substituted elements
+  // keep their attributes and children
+  template <std::size_t N>
+  static void element(const map::StaticEntry<Handler> (&handlers)[N],
+                      const pugi::xml_node &in, common::HtmlWriter &out,
+                      Context &context, Translator attributes,
+                      Translator children) {
+    const Handler *handler = map::lookup_static(handlers, in.name());
+
+    if (handler == nullptr) {
+      children(in, out, context);
+      return;
+    }
+
+    switch (handler->type) {
+    case Type::SKIP:
+      break;
+    case Type::TRANSLATE:
+      handler->translator(in, out, context);
+      break;
+    case Type::SUBSTITUTE:
+      out << "<" << handler->tag;
+      attributes(in, out, context);
+      out << ">";
+      children(in, out, context);
+      out << "</" << handler->tag << ">";
+      break;
+    }
+  }
+};
+} // namespace odr::internal::util::element
+
+#endif // ODR_INTERNAL_UTIL_ELEMENT_H
@@ -1,6 +1,11 @@
 #ifndef ODR_INTERNAL_UTIL_MAP_H
 #define ODR_INTERNAL_UTIL_MAP_H
 
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
 namespace odr::internal::util::map {
 template <typename Map, typename Key, typename Value>
 bool lookupMap(const Map &map, const Key &key, Value &value) {
@@ -21,6 +26,44 @@ bool lookup_map_default(const Map &map, const Key &key, Value &value,
   }
   return true;
 }
+
+// entry of a constant table which is sorted by `key`; allows allocation free
+// lookups on raw C strings e.g. pugixml element and attribute names
+template <typename Value> struct StaticEntry {
+  const char *key;
+  Value value;
+};
+
+// meant for `static_assert`; keys must be strictly ascending
+template <typename Value, std::size_t N>
+constexpr bool is_sorted(const StaticEntry<Value> (&table)[N]) {
+  for (std::size_t i = 1; i < N; ++i) {
+    if (std::string_view(table[i - 1].key) >= std::string_view(table[i].key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Value, std::size_t N>
+const Value *lookup_static(const StaticEntry<Value> (&table)[N],
+                           const char *key) noexcept {
+  std::size_t first = 0;
+  std::size_t last = N;
+  while (first < last) {
+    const std::size_t middle = first + (last - first) / 2;
+    const int compare = std::strcmp(table[middle].key, key);
+    if (compare == 0) {
+      return &table[middle].value;
+    }
+    if (compare < 0) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return nullptr;
+}
 } // namespace odr::internal::util::map
 
 #endif // ODR_INTERNAL_UTIL_MAP_H
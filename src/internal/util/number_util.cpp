@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <internal/util/number_util.h>
+
+namespace odr::internal::util {
+
+namespace {
+constexpr std::uint64_t powers_of_ten[number::max_precision + 1]{
+    1,      10,      100,      1000,      10000,
+    100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// largest magnitude which can be scaled into an `std::uint64_t`
+constexpr double max_scaled = 1e18;
+
+// significant digits of `to_chars_scientific` after the first one; like `%g`
+constexpr std::uint32_t mantissa_precision = 5;
+
+// mantissa in fixed point and the exponent as integer like `%g` does; meant
+// for finite magnitudes beyond the fixed point range
+char *to_chars_scientific(char *first, const double value) noexcept {
+  const double magnitude = std::abs(value);
+  int exponent = static_cast<int>(std::floor(std::log10(magnitude)));
+  double mantissa = magnitude / std::pow(10.0, exponent);
+  // `log10` might be off by one
+  if (mantissa < 1) {
+    mantissa *= 10;
+    --exponent;
+  }
+  // rounding of the mantissa to `precision` digits might carry over
+  constexpr std::uint64_t scale = powers_of_ten[mantissa_precision];
+  if (std::llround(mantissa * scale) >= static_cast<long long>(10 * scale)) {
+    mantissa /= 10;
+    ++exponent;
+  }
+
+  if (std::signbit(value)) {
+    *first++ = '-';
+  }
+  first = number::to_chars(first, mantissa, mantissa_precision);
+  *first++ = 'e';
+  *first++ = exponent < 0 ? '-' : '+';
+  exponent = std::abs(exponent);
+  if (exponent < 10) {
+    *first++ = '0';
+  }
+  return std::to_chars(first, first + 3, exponent).ptr;
+}
+} // namespace
+
+char *number::to_chars(char *first, const double value, std::uint32_t precision,
+                       const bool trim) noexcept {
+  char *const last = first + max_length;
+  precision = std::min(precision, max_precision);
+
+  if (std::isnan(value)) {
+    std::memcpy(first, "nan", 3);
+    return first + 3;
+  }
+  if (std::isinf(value)) {
+    if (std::signbit(value)) {
+      *first++ = '-';
+    }
+    std::memcpy(first, "inf", 3);
+    return first + 3;
+  }
+
+  const double magnitude = std::abs(value);
+  const auto scale = static_cast<double>(powers_of_ten[precision]);
+  if (!(magnitude * scale < max_scaled)) {
+    // out of fixed point range; absurdly large lengths. floating point
+    // `std::to_chars` is not available with older standard libraries
+    return to_chars_scientific(first, value);
+  }
+
+  const auto scaled =
+      static_cast<std::uint64_t>(std::llround(magnitude * scale));
+  const std::uint64_t integral = scaled / powers_of_ten[precision];
+  std::uint64_t fraction = scaled % powers_of_ten[precision];
+
+  if (std::signbit(value) && (scaled != 0)) {
+    *first++ = '-';
+  }
+  first = std::to_chars(first, last, integral).ptr;
+
+  if (trim) {
+    while ((precision > 0) && (fraction % 10 == 0)) {
+      fraction /= 10;
+      --precision;
+    }
+  }
+  if (precision == 0) {
+    return first;
+  }
+
+  *first++ = '.';
+  for (std::uint32_t i = precision; i > 0; --i) {
+    first[i - 1] = static_cast<char>('0' + fraction % 10);
+    fraction /= 10;
+  }
+  return first + precision;
+}
+
+std::string number::to_string(const double value, const std::uint32_t precision,
+                              const bool trim) {
+  char buffer[max_length];
+  return std::string(buffer, to_chars(buffer, value, precision, trim));
+}
+
+} // namespace odr::internal::util
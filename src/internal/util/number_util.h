@@ -0,0 +1,34 @@
+#ifndef ODR_INTERNAL_UTIL_NUMBER_H
+#define ODR_INTERNAL_UTIL_NUMBER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace odr::internal::util::number {
+// buffer size which is sufficient for `to_chars`
+constexpr std::size_t max_length = 32;
+constexpr std::uint32_t max_precision = 9;
+
+// locale independent fixed point formatting with `precision` fractional
+// digits; trailing zeros of the fraction are dropped if `trim` is set.
+// `first` has to point to at least `max_length` chars. returns the end.
+char *to_chars(char *first, double value, std::uint32_t precision,
+               bool trim = true) noexcept;
+std::string to_string(double value, std::uint32_t precision,
+                      bool trim = true);
+
+// office units
+// https://startbigthinksmall.wordpress.com/2010/01/04/points-inches-and-emus-measuring-units-in-office-open-xml/
+constexpr double emus_per_inch = 914400.0;
+constexpr double twips_per_inch = 1440.0;
+
+constexpr double emu_to_inch(const double emu) noexcept {
+  return emu * (1.0 / emus_per_inch);
+}
+constexpr double twip_to_inch(const double twip) noexcept {
+  return twip * (1.0 / twips_per_inch);
+}
+} // namespace odr::internal::util::number
+
+#endif // ODR_INTERNAL_UTIL_NUMBER_H
@@ -1,8 +1,7 @@
 #include <codecvt>
+#include <internal/util/number_util.h>
 #include <internal/util/string_util.h>
-#include <iomanip>
 #include <locale>
-#include <sstream>
 
 namespace odr::internal::util {
 
@@ -26,9 +25,7 @@ void string::replace_all(std::string &string, const std::string &search,
 }
 
 std::string string::to_string(const double d, const std::uint32_t precision) {
-  std::stringstream stream;
-  stream << std::fixed << std::setprecision(precision) << d;
-  return stream.str();
+  return number::to_string(d, precision, false);
 }
 
 std::string string::u16string_to_string(const std::u16string &string) {
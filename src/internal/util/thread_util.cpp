@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <internal/util/thread_util.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace odr::internal::util {
+
+std::size_t thread::default_concurrency() noexcept {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void thread::parallel_for(const std::size_t count,
+                          const std::size_t concurrency,
+                          const std::function<void(std::size_t)> &function) {
+  const std::size_t workers = std::min(count, concurrency);
+  if (workers <= 1) {
+    for (std::size_t i = 0; i < count; ++i) {
+      function(i);
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::mutex mutex;
+  std::exception_ptr error;
+
+  const auto work = [&]() {
+    for (std::size_t i = next++; i < count; i = next++) {
+      try {
+        function(i);
+      } catch (...) {
+        std::lock_guard lock(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next = count;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (std::size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &&t : threads) {
+    t.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace odr::internal::util
@@ -0,0 +1,18 @@
+#ifndef ODR_INTERNAL_UTIL_THREAD_H
+#define ODR_INTERNAL_UTIL_THREAD_H
+
+#include <cstddef>
+#include <functional>
+
+namespace odr::internal::util::thread {
+// number of hardware threads; at least one
+std::size_t default_concurrency() noexcept;
+
+// calls `function` for every index in [0, `count`) on up to `concurrency`
+// threads including the calling one. the first exception thrown is rethrown
+// after all workers are done; remaining indices are skipped.
+void parallel_for(std::size_t count, std::size_t concurrency,
+                  const std::function<void(std::size_t)> &function);
+} // namespace odr::internal::util::thread
+
+#endif // ODR_INTERNAL_UTIL_THREAD_H
@@ -1,15 +1,14 @@
 #ifndef ODR_INTERNAL_UTIL_XML_H
 #define ODR_INTERNAL_UTIL_XML_H
 
+#include <cstddef>
 #include <exception>
+#include <internal/util/map_util.h>
+#include <pugixml.hpp>
 #include <string>
 
-namespace pugi {
-class xml_document;
-} // namespace pugi
-
 namespace odr::internal::abstract {
-class ReadStorage;
+class ReadableFilesystem;
 }
 
 namespace odr::internal::common {
@@ -21,6 +20,25 @@ pugi::xml_document parse(const std::string &);
 pugi::xml_document parse(std::istream &);
 pugi::xml_document parse(const abstract::ReadableFilesystem &,
                          const common::Path &);
+
+// maps qualified attribute names to members of a plain struct of attributes;
+// must be sorted by name
+template <typename Attributes>
+using AttributeSchema = map::StaticEntry<pugi::xml_attribute Attributes::*>;
+
+// walks the attributes of `node` once and picks the ones known by `schema`
+// instead of probing `node.attribute(...)` for each of them
+template <typename Attributes, std::size_t N>
+Attributes read_attributes(const pugi::xml_node &node,
+                           const AttributeSchema<Attributes> (&schema)[N]) {
+  Attributes result{};
+  for (auto a = node.first_attribute(); a; a = a.next_attribute()) {
+    if (const auto member = map::lookup_static(schema, a.name()); member) {
+      result.*(*member) = a;
+    }
+  }
+  return result;
+}
 } // namespace odr::internal::util::xml
 
 #endif // ODR_INTERNAL_XML_UTIL_H
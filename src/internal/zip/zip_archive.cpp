@@ -88,6 +88,10 @@ ReadonlyZipArchive::ReadonlyZipArchive(
     const std::shared_ptr<common::DiscFile> &file)
     : m_zip{std::make_shared<util::Archive>(file)} {}
 
+ReadonlyZipArchive::ReadonlyZipArchive(
+    const std::shared_ptr<abstract::File> &file)
+    : m_zip{std::make_shared<util::Archive>(file)} {}
+
 ReadonlyZipArchive::Iterator ReadonlyZipArchive::begin() const {
   return Iterator(*this, 0);
 }
@@ -29,6 +29,8 @@ class ReadonlyZipArchive final {
 public:
   explicit ReadonlyZipArchive(const std::shared_ptr<common::MemoryFile> &file);
   explicit ReadonlyZipArchive(const std::shared_ptr<common::DiscFile> &file);
+  // `file` has to provide seekable streams
+  explicit ReadonlyZipArchive(const std::shared_ptr<abstract::File> &file);
 
   class Iterator;
 
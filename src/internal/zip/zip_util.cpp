@@ -80,7 +80,8 @@ Archive::Archive(const std::shared_ptr<common::DiscFile> &file)
     : Archive(std::dynamic_pointer_cast<abstract::File>(file)) {}
 
 Archive::Archive(std::shared_ptr<abstract::File> file)
-    : m_file{std::move(file)}, m_data{m_file->read()} {
+    : m_file{std::move(file)}, m_source{std::make_unique<Source>()} {
+  m_source->stream = m_file->read();
   init_();
 }
 
@@ -94,7 +95,8 @@ Archive &Archive::operator=(const Archive &other) {
   if (&other != this) {
     m_zip = other.m_zip;
     m_file = other.m_file;
-    m_data = m_file->read();
+    m_source = std::make_unique<Source>();
+    m_source->stream = m_file->read();
     init_();
   }
   return *this;
@@ -103,13 +105,16 @@ Archive &Archive::operator=(const Archive &other) {
 Archive &Archive::operator=(Archive &&) noexcept = default;
 
 void Archive::init_() {
-  m_zip.m_pIO_opaque = m_data.get();
+  m_zip.m_pIO_opaque = m_source.get();
   m_zip.m_pRead = [](void *opaque, std::uint64_t offset, void *buffer,
                      std::size_t size) {
-    auto in = static_cast<std::istream *>(opaque);
-    in->seekg(offset);
-    in->read(static_cast<char *>(buffer), size);
-    return size;
+    auto source = static_cast<Source *>(opaque);
+    std::lock_guard lock(source->mutex);
+    // a short read before leaves the stream failed
+    source->stream->clear();
+    source->stream->seekg(offset);
+    source->stream->read(static_cast<char *>(buffer), size);
+    return static_cast<std::size_t>(source->stream->gcount());
   };
   const bool state = mz_zip_reader_init(
       &m_zip, m_file->size(), MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
@@ -130,17 +135,44 @@ FileLocation FileInZip::location() const noexcept {
   return m_archive->file()->location();
 }
 
-std::size_t FileInZip::size() const {
-  mz_zip_archive_file_stat stat{};
-  mz_zip_reader_file_stat(m_archive->zip(), m_index, &stat);
-  return stat.m_uncomp_size;
-}
+std::size_t FileInZip::size() const { return stat_().m_uncomp_size; }
 
 std::unique_ptr<std::istream> FileInZip::read() const {
   auto iter = mz_zip_reader_extract_iter_new(m_archive->zip(), m_index, 0);
   return std::make_unique<FileInZipIstream>(m_archive, iter);
 }
 
+bool FileInZip::compressed() const { return stat_().m_method != 0; }
+
+std::uint64_t FileInZip::data_offset() const {
+  // the local header repeats the variable length fields of the central
+  // directory which may differ in size
+  // https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT 4.3.7
+  constexpr std::size_t header_size = 30;
+  const std::uint64_t header_offset = stat_().m_local_header_ofs;
+  mz_zip_archive *zip = m_archive->zip();
+  unsigned char header[header_size];
+  if ((zip->m_pRead(zip->m_pIO_opaque, header_offset, header, header_size) !=
+       header_size) ||
+      (header[0] != 'P') || (header[1] != 'K') || (header[2] != 3) ||
+      (header[3] != 4)) {
+    throw NoZipFile();
+  }
+  const std::uint32_t name_length = header[26] | (header[27] << 8);
+  const std::uint32_t extra_length = header[28] | (header[29] << 8);
+  return header_offset + header_size + name_length + extra_length;
+}
+
+std::shared_ptr<abstract::File> FileInZip::archive_file() const {
+  return m_archive->file();
+}
+
+mz_zip_archive_file_stat FileInZip::stat_() const {
+  mz_zip_archive_file_stat stat{};
+  mz_zip_reader_file_stat(m_archive->zip(), m_index, &stat);
+  return stat;
+}
+
 bool append_file(mz_zip_archive &archive, const std::string &path,
                  std::istream &istream, const std::size_t size,
                  const std::time_t &time, const std::string &comment,
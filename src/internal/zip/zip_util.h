@@ -6,6 +6,7 @@
 #include <istream>
 #include <memory>
 #include <miniz.h>
+#include <mutex>
 #include <string>
 
 namespace odr::internal::common {
@@ -19,6 +20,8 @@ class Archive final {
 public:
   explicit Archive(const std::shared_ptr<common::MemoryFile> &file);
   explicit Archive(const std::shared_ptr<common::DiscFile> &file);
+  // `file` has to provide seekable streams
+  explicit Archive(std::shared_ptr<abstract::File> file);
   Archive(const Archive &);
   Archive(Archive &&) noexcept;
   ~Archive();
@@ -30,11 +33,16 @@ public:
   [[nodiscard]] std::shared_ptr<abstract::File> file() const;
 
 private:
+  // the stream is shared by all readers of the archive which may live on
+  // different threads; every read seeks
+  struct Source {
+    std::unique_ptr<std::istream> stream;
+    std::mutex mutex;
+  };
+
   mutable mz_zip_archive m_zip{};
   std::shared_ptr<abstract::File> m_file;
-  std::unique_ptr<std::istream> m_data;
-
-  explicit Archive(std::shared_ptr<abstract::File> file);
+  std::unique_ptr<Source> m_source;
 
   void init_();
 };
@@ -47,9 +55,17 @@ public:
   [[nodiscard]] std::size_t size() const final;
   [[nodiscard]] std::unique_ptr<std::istream> read() const final;
 
+  // the entry as it is stored inside of the archive file
+  [[nodiscard]] bool compressed() const;
+  // offset of the raw entry data inside of `archive_file()`
+  [[nodiscard]] std::uint64_t data_offset() const;
+  [[nodiscard]] std::shared_ptr<abstract::File> archive_file() const;
+
 private:
   std::shared_ptr<Archive> m_archive;
   std::uint32_t m_index;
+
+  [[nodiscard]] mz_zip_archive_file_stat stat_() const;
 };
 
 bool append_file(mz_zip_archive &archive, const std::string &path,
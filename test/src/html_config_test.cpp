@@ -0,0 +1,171 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <internal/abstract/file.h>
+#include <internal/abstract/filesystem.h>
+#include <internal/common/archive.h>
+#include <internal/common/file.h>
+#include <internal/common/path.h>
+#include <internal/crypto/crypto_util.h>
+#include <internal/util/stream_util.h>
+#include <internal/zip/zip_archive.h>
+#include <memory>
+#include <odr/document.h>
+#include <odr/file_meta.h>
+#include <odr/file_type.h>
+#include <odr/html_config.h>
+#include <string>
+#include <string_view>
+#include <test_util.h>
+#include <vector>
+
+using namespace odr;
+using namespace odr::internal;
+using namespace odr::test;
+namespace fs = std::filesystem;
+
+namespace {
+std::string read_file(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  return util::stream::read(in);
+}
+
+std::string hex(const std::string &data) {
+  static constexpr char digits[] = "0123456789abcdef";
+  std::string result;
+  for (const unsigned char c : data) {
+    result += digits[c >> 4];
+    result += digits[c & 0xf];
+  }
+  return result;
+}
+
+// unencrypted test files of `type` with more than one entry
+std::vector<std::string> multi_entry_files(const FileType type) {
+  std::vector<std::string> result;
+  for (auto &&path : TestData::test_file_paths()) {
+    const TestFile file = TestData::test_file(path);
+    if ((file.type != type) || file.password_encrypted) {
+      continue;
+    }
+    const Document document(file.path);
+    if (!document.encrypted() && (document.meta().entry_count > 1)) {
+      result.push_back(file.path);
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST(HtmlConfig, parallel) {
+  for (const FileType type : {FileType::OFFICE_OPEN_XML_PRESENTATION,
+                              FileType::OFFICE_OPEN_XML_WORKBOOK}) {
+    const auto paths = multi_entry_files(type);
+    EXPECT_FALSE(paths.empty());
+    for (auto &&path : paths) {
+      const Document document(path);
+      HtmlConfig config;
+      document.translate("html_config_serial.html", config);
+      config.parallel = true;
+      document.translate("html_config_parallel.html", config);
+      // not `EXPECT_EQ` to keep the whole documents out of the log
+      EXPECT_TRUE(read_file("html_config_serial.html") ==
+                  read_file("html_config_parallel.html"))
+          << path;
+    }
+  }
+}
+
+TEST(HtmlConfig, split_entries) {
+  for (const FileType type : {FileType::OPENDOCUMENT_PRESENTATION,
+                              FileType::OPENDOCUMENT_SPREADSHEET,
+                              FileType::OFFICE_OPEN_XML_PRESENTATION,
+                              FileType::OFFICE_OPEN_XML_WORKBOOK}) {
+    const auto paths = multi_entry_files(type);
+    ASSERT_FALSE(paths.empty());
+    const Document document(paths.front());
+    const fs::path directory = "html_config_split";
+    fs::remove_all(directory);
+
+    HtmlConfig config;
+    config.split_entries = true;
+    document.translate(directory.string(), config);
+
+    EXPECT_TRUE(fs::is_regular_file(directory / "style.css"));
+    EXPECT_TRUE(fs::is_regular_file(directory / "script.js"));
+    const std::uint32_t entry_count = document.meta().entry_count;
+    for (std::uint32_t i = 0; i < entry_count; ++i) {
+      const fs::path entry =
+          directory / ("entry-" + std::to_string(i) + ".html");
+      ASSERT_TRUE(fs::is_regular_file(entry)) << paths.front();
+      const std::string html = read_file(entry);
+      EXPECT_NE(std::string::npos,
+                html.find(R"(<link rel="stylesheet" href="style.css"/>)"))
+          << entry;
+      EXPECT_NE(std::string::npos,
+                html.find(R"(<script src="script.js"></script>)"))
+          << entry;
+    }
+    EXPECT_FALSE(fs::exists(
+        directory / ("entry-" + std::to_string(entry_count) + ".html")));
+  }
+}
+
+TEST(HtmlConfig, external_resources) {
+  // a text document referencing a picture which is not converted
+  std::string path;
+  std::shared_ptr<abstract::ReadableFilesystem> filesystem;
+  std::string href;
+  for (auto &&test_path : TestData::test_file_paths()) {
+    const TestFile file = TestData::test_file(test_path);
+    if ((file.type != FileType::OPENDOCUMENT_TEXT) ||
+        file.password_encrypted) {
+      continue;
+    }
+    common::ArchiveFile<zip::ReadonlyZipArchive> zip(
+        std::make_shared<common::DiscFile>(file.path));
+    filesystem = zip.archive()->filesystem();
+    const std::string content =
+        util::stream::read(*filesystem->open("content.xml")->read());
+    constexpr std::string_view attribute = "xlink:href=\"";
+    const auto begin = content.find(std::string(attribute) + "Pictures/");
+    if (begin == std::string::npos) {
+      continue;
+    }
+    const auto first = begin + attribute.size();
+    href = content.substr(first, content.find('"', first) - first);
+    if ((href.find(".svm") == std::string::npos) &&
+        filesystem->is_file(common::Path(href))) {
+      path = file.path;
+      break;
+    }
+  }
+  ASSERT_FALSE(path.empty());
+
+  const fs::path directory = "html_config_external";
+  fs::remove_all(directory);
+  fs::create_directories(directory);
+  const Document document(path);
+  HtmlConfig config;
+  config.external_resources = true;
+  document.translate((directory / "document.html").string(), config);
+
+  const std::string picture =
+      util::stream::read(*filesystem->open(common::Path(href))->read());
+  const std::string name = hex(crypto::util::sha256(picture)) + "." +
+                           common::Path(href).extension();
+  EXPECT_EQ(picture, read_file(directory / "media" / name)) << href;
+  // written once however often it is referenced
+  std::size_t copies = 0;
+  for (auto &&e : fs::directory_iterator(directory / "media")) {
+    copies += read_file(e.path()) == picture;
+  }
+  EXPECT_EQ(1, copies);
+
+  const std::string html = read_file(directory / "document.html");
+  EXPECT_NE(std::string::npos, html.find(R"(loading="lazy")"));
+  EXPECT_NE(std::string::npos, html.find("src=\"media/" + name + "\""))
+      << name;
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <internal/common/html_writer.h>
+#include <sstream>
+
+using namespace odr::internal::common;
+
+TEST(HtmlWriter, memory) {
+  HtmlWriter out;
+  out << "<p" << ' ' << std::string("class=\"a\"") << ">" << 42u << -7
+      << "</p>";
+  EXPECT_EQ("<p class=\"a\">42-7</p>", out.str());
+}
+
+TEST(HtmlWriter, escape) {
+  HtmlWriter out;
+  out.write_escaped("a & b < c > d");
+  EXPECT_EQ("a &amp; b &lt; c &gt; d", out.str());
+}
+
+TEST(HtmlWriter, escape_long) {
+  std::string text(100, 'x');
+  text[0] = '&';
+  text[17] = '<';
+  text[99] = '>';
+
+  std::string expected = text;
+  expected.replace(99, 1, "&gt;");
+  expected.replace(17, 1, "&lt;");
+  expected.replace(0, 1, "&amp;");
+
+  HtmlWriter out;
+  out.write_escaped(text);
+  EXPECT_EQ(expected, out.str());
+}
+
+TEST(HtmlWriter, sink) {
+  std::ostringstream sink;
+  {
+    HtmlWriter out(sink, 4);
+    out << "ab" << "cdef" << "0123456789" << 'x';
+    out.write_escaped("<>");
+  }
+  EXPECT_EQ("abcdef0123456789x&lt;&gt;", sink.str());
+}
+
+TEST(HtmlWriter, base64) {
+  const std::string data(100000, 'a');
+
+  std::istringstream in(data);
+  std::ostringstream sink;
+  {
+    HtmlWriter out(sink);
+    out.write_base64(in);
+  }
+
+  HtmlWriter out;
+  out.write_base64(data);
+
+  EXPECT_EQ(133336, sink.str().size());
+  EXPECT_EQ(out.str(), sink.str());
+  EXPECT_EQ("YWFh", sink.str().substr(0, 4));
+  EXPECT_EQ("YQ==", sink.str().substr(sink.str().size() - 4));
+}
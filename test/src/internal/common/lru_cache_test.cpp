@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <internal/common/lru_cache.h>
+#include <string>
+
+using namespace odr::internal::common;
+
+TEST(LruCache, find) {
+  LruCache<int, std::string> cache(10);
+  EXPECT_EQ(nullptr, cache.find(1));
+
+  cache.insert(1, "a", 1);
+  ASSERT_NE(nullptr, cache.find(1));
+  EXPECT_EQ("a", *cache.find(1));
+
+  cache.insert(1, "b", 2);
+  EXPECT_EQ("b", *cache.find(1));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(2, cache.cost());
+}
+
+TEST(LruCache, evict) {
+  LruCache<int, std::string> cache(10);
+  cache.insert(1, "a", 4);
+  cache.insert(2, "b", 4);
+  EXPECT_NE(nullptr, cache.find(1));
+  const auto c = cache.insert(3, "c", 4);
+
+  EXPECT_NE(nullptr, cache.find(1));
+  EXPECT_EQ(nullptr, cache.find(2));
+  EXPECT_NE(nullptr, cache.find(3));
+  EXPECT_EQ(8, cache.cost());
+
+  cache.budget(4);
+  EXPECT_EQ(nullptr, cache.find(1));
+  EXPECT_EQ("c", *c);
+}
+
+TEST(LruCache, over_budget) {
+  LruCache<int, std::string> cache(10);
+  const auto value = cache.insert(1, "a", 11);
+
+  EXPECT_EQ("a", *value);
+  EXPECT_EQ(nullptr, cache.find(1));
+  EXPECT_EQ(0, cache.size());
+}
@@ -0,0 +1,38 @@
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <internal/common/resource_writer.h>
+#include <internal/util/stream_util.h>
+#include <string>
+
+using namespace odr::internal;
+using namespace odr::internal::common;
+
+namespace {
+// sha256 of "abc"
+constexpr const char *abc_name =
+    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+} // namespace
+
+TEST(ResourceWriter, write) {
+  const std::filesystem::path directory = "resource_writer_write";
+  std::filesystem::remove_all(directory);
+  ResourceWriter writer(directory, "media/");
+
+  EXPECT_EQ(std::string("media/") + abc_name + ".svg",
+            writer.write("abc", "svg"));
+  EXPECT_EQ(std::string("media/") + abc_name + ".svg",
+            writer.write("abc", "svg"));
+  std::ifstream in(directory / (std::string(abc_name) + ".svg"));
+  EXPECT_EQ("abc", util::stream::read(in));
+}
+
+TEST(ResourceWriter, drop_unusual_extension) {
+  const std::filesystem::path directory = "resource_writer_extension";
+  std::filesystem::remove_all(directory);
+  ResourceWriter writer(directory, "");
+
+  EXPECT_EQ(abc_name, writer.write("abc", "svg\" onerror=\"x"));
+  EXPECT_EQ(abc_name, writer.write("abc", "../svg"));
+  EXPECT_EQ(abc_name, writer.write("abc", ""));
+}
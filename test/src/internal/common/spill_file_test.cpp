@@ -0,0 +1,87 @@
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <internal/common/file.h>
+#include <internal/common/spill_file.h>
+#include <internal/util/stream_util.h>
+#include <memory>
+#include <odr/exceptions.h>
+#include <odr/file_location.h>
+#include <sstream>
+#include <string>
+
+using namespace odr;
+using namespace odr::internal;
+using namespace odr::internal::common;
+
+TEST(MemoryBudget, reserve) {
+  MemoryBudget parent(10, nullptr);
+  MemoryBudget budget(8, &parent);
+
+  EXPECT_TRUE(budget.reserve(6));
+  EXPECT_FALSE(budget.reserve(3));
+  EXPECT_TRUE(parent.reserve(4));
+  EXPECT_FALSE(budget.reserve(1));
+  EXPECT_EQ(6, budget.used());
+  EXPECT_EQ(10, parent.used());
+
+  budget.release(6);
+  EXPECT_EQ(0, budget.used());
+  EXPECT_EQ(4, parent.used());
+}
+
+TEST(SpillFile, memory) {
+  const auto budget = std::make_shared<MemoryBudget>(16, nullptr);
+  std::istringstream in("hello world");
+  {
+    const SpillFile file(in, budget);
+    EXPECT_EQ(FileLocation::MEMORY, file.location());
+    EXPECT_EQ(11, file.size());
+    EXPECT_EQ("hello world", file.content());
+    EXPECT_EQ("hello world", util::stream::read(*file.read()));
+    EXPECT_EQ(11, budget->used());
+  }
+  EXPECT_EQ(0, budget->used());
+}
+
+TEST(SpillFile, spill) {
+  const auto budget = std::make_shared<MemoryBudget>(16, nullptr);
+  const std::string content(100000, 'x');
+  const SpillFile file(MemoryFile(content), budget);
+
+  EXPECT_EQ(FileLocation::DISC, file.location());
+  EXPECT_EQ(content.size(), file.size());
+  EXPECT_EQ(content, file.content());
+  EXPECT_EQ(0, budget->used());
+
+  const auto in = file.read();
+  in->seekg(-3, std::ios::end);
+  EXPECT_EQ("xxx", util::stream::read(*in));
+}
+
+TEST(SpillFile, disc) {
+  const auto budget = std::make_shared<MemoryBudget>(16, nullptr);
+  const std::string content(100000, 'y');
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "odr-spill-file-test").string();
+  std::ofstream(path, std::ios::binary) << content;
+  const TemporaryDiscFile disc_file(path);
+
+  const SpillFile file(disc_file, budget);
+  EXPECT_EQ(FileLocation::DISC, file.location());
+  EXPECT_EQ(content, file.content());
+  EXPECT_EQ(0, budget->used());
+}
+
+TEST(SpillFile, read_error) {
+  // exceptions of the buffer are turned into `badbit` by the stream
+  class FailingBuffer final : public std::streambuf {
+  protected:
+    int_type underflow() final { throw FileReadError(); }
+  };
+
+  const auto budget = std::make_shared<MemoryBudget>(16, nullptr);
+  FailingBuffer buffer;
+  std::istream in(&buffer);
+  EXPECT_THROW(SpillFile(in, budget), FileReadError);
+}
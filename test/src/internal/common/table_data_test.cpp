@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <internal/common/html_writer.h>
+#include <internal/common/table_data.h>
+#include <string>
+
+using namespace odr::internal::common;
+
+namespace {
+std::string payload(const TableData &data, const std::uint32_t rows) {
+  HtmlWriter out;
+  data.write("", rows, out);
+  const std::string &html = out.str();
+  const auto begin = html.find('{');
+  const auto end = html.rfind('}');
+  return html.substr(begin, end - begin + 1);
+}
+} // namespace
+
+TEST(TableData, empty) {
+  TableData data;
+  EXPECT_EQ(R"({"rows":0,"cols":0,"strings":[],"columns":[],)"
+            R"("rowAttributes":[],"cells":[]})",
+            payload(data, 0));
+}
+
+TEST(TableData, cells) {
+  TableData data;
+  data.add_column(0, 2, R"( class="c")", "");
+  data.add_row(1, R"( class="r")");
+  data.add_cell(1, 0, 1, 1, R"( class="c")", "a</script>");
+  data.add_cell(1, 3, 1, 2, "", "\"b\"");
+  EXPECT_EQ(R"({"rows":3,"cols":4,"strings":[""," class=\"c\"",)"
+            R"(" class=\"r\"","a\u003c/script>","\"b\""],)"
+            R"("columns":[0,2,1,0],"rowAttributes":[1,2],)"
+            R"("cells":[1,0,1,1,1,3,1,3,1,2,0,4]})",
+            payload(data, 3));
+}
+
+TEST(TableData, repeat) {
+  TableData data;
+  data.add_cell(0, 0, 1, 1, "", "x");
+  const auto begin = data.mark();
+  data.add_row(1, R"( class="r")");
+  data.add_cell(1, 1, 1, 1, "", "y");
+  const auto end = data.mark();
+  data.repeat(begin, end, 1);
+  data.repeat(begin, end, 2);
+  EXPECT_EQ(R"({"rows":4,"cols":2,"strings":["","x"," class=\"r\"","y"],)"
+            R"("columns":[],"rowAttributes":[1,2,2,2,3,2],)"
+            R"("cells":[0,0,1,1,0,1,1,1,1,1,0,3,2,1,1,1,0,3,3,1,1,1,0,3]})",
+            payload(data, 4));
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <internal/common/table_position.h>
+#include <stdexcept>
 
 using namespace odr::internal::common;
 
@@ -48,3 +49,31 @@ TEST(TablePosition, string4) {
   EXPECT_EQ(702, tp.col());
   EXPECT_EQ(input, tp.to_string());
 }
+
+TEST(TablePosition, parse) {
+  const auto tp = TablePosition::parse("XFD1048576");
+  ASSERT_TRUE(tp);
+  EXPECT_EQ(1048575, tp->row());
+  EXPECT_EQ(16383, tp->col());
+}
+
+TEST(TablePosition, parse_malformed) {
+  EXPECT_FALSE(TablePosition::parse(""));
+  EXPECT_FALSE(TablePosition::parse("A"));
+  EXPECT_FALSE(TablePosition::parse("1"));
+  EXPECT_FALSE(TablePosition::parse("A0"));
+  EXPECT_FALSE(TablePosition::parse("a1"));
+  EXPECT_FALSE(TablePosition::parse("A1B"));
+  EXPECT_FALSE(TablePosition::parse("$A$1"));
+  EXPECT_FALSE(TablePosition::parse("AAAAAAA1"));
+  EXPECT_FALSE(TablePosition::parse("A4294967297"));
+  EXPECT_THROW(TablePosition("A0"), std::invalid_argument);
+}
+
+TEST(TablePosition, parse_row) {
+  EXPECT_EQ(0, TablePosition::parse_row("1"));
+  EXPECT_EQ(41, TablePosition::parse_row("42"));
+  EXPECT_FALSE(TablePosition::parse_row(""));
+  EXPECT_FALSE(TablePosition::parse_row("0"));
+  EXPECT_FALSE(TablePosition::parse_row("1A"));
+}
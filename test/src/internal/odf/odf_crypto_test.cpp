@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <internal/abstract/filesystem.h>
+#include <internal/common/archive.h>
+#include <internal/common/file.h>
+#include <internal/common/path.h>
+#include <internal/common/spill_file.h>
+#include <internal/odf/odf_manifest.h>
+#include <internal/odf/odf_translator.h>
+#include <internal/util/xml_util.h>
+#include <internal/zip/zip_archive.h>
+#include <memory>
+#include <odr/document.h>
+#include <odr/file_type.h>
+#include <odr/html_config.h>
+#include <pugixml.hpp>
+#include <sstream>
+#include <string>
+#include <test_util.h>
+#include <unordered_map>
+
+using namespace odr;
+using namespace odr::internal;
+using namespace odr::test;
+
+namespace {
+std::shared_ptr<abstract::ReadableFilesystem>
+open_zip(const std::string &path) {
+  common::ArchiveFile<zip::ReadonlyZipArchive> zip(
+      std::make_shared<common::DiscFile>(path));
+  return zip.archive()->filesystem();
+}
+
+// printed by pugixml so that the formatting does not matter
+std::string printed(const abstract::ReadableFilesystem &filesystem,
+                    const common::Path &path) {
+  std::ostringstream out;
+  util::xml::parse(filesystem, path).print(out);
+  return out.str();
+}
+
+// full path to media type
+std::unordered_map<std::string, std::string>
+media_types(const abstract::ReadableFilesystem &filesystem) {
+  std::unordered_map<std::string, std::string> result;
+  const auto manifest = util::xml::parse(filesystem, "META-INF/manifest.xml");
+  for (auto &&e : manifest.child("manifest:manifest").children()) {
+    result[e.attribute("manifest:full-path").as_string()] =
+        e.attribute("manifest:media-type").as_string();
+  }
+  return result;
+}
+} // namespace
+
+TEST(OdfCrypto, save_encrypted) {
+  const std::string input =
+      TestData::test_file_path("odr-public/odt/style-various-1.odt");
+  const std::string output = "style-various-1-encrypted.odt";
+  const std::string password = "Password1234_";
+
+  {
+    const Document document(input);
+    // `content.xml` is saved from the translated document
+    document.translate("style-various-1.html", HtmlConfig());
+    ASSERT_TRUE(document.savable(true));
+    document.save(output, password);
+  }
+
+  {
+    const Document document(output);
+    EXPECT_EQ(FileType::OPENDOCUMENT_TEXT, document.type());
+    EXPECT_TRUE(document.encrypted());
+    EXPECT_FALSE(document.decrypt("wrong"));
+    EXPECT_TRUE(document.decrypt(password));
+    EXPECT_TRUE(document.decrypted());
+  }
+
+  const auto original = open_zip(input);
+  const auto saved = open_zip(output);
+  odf::OpenDocumentTranslator decrypted(
+      saved, std::make_shared<common::MemoryBudget>());
+  ASSERT_TRUE(decrypted.decrypt(password));
+  EXPECT_EQ(printed(*original, "content.xml"),
+            printed(decrypted.filesystem(), "content.xml"));
+  EXPECT_EQ(printed(*original, "styles.xml"),
+            printed(decrypted.filesystem(), "styles.xml"));
+
+  const auto original_media_types = media_types(*original);
+  const auto saved_media_types = media_types(*saved);
+  for (auto &&[path, media_type] : original_media_types) {
+    const auto it = saved_media_types.find(path);
+    ASSERT_NE(std::end(saved_media_types), it) << path;
+    EXPECT_EQ(media_type, it->second) << path;
+  }
+
+  const odf::Manifest manifest =
+      odf::parse_manifest(util::xml::parse(*saved, "META-INF/manifest.xml"));
+  EXPECT_TRUE(manifest.encrypted);
+  EXPECT_EQ(0, manifest.entries.count("mimetype"));
+  EXPECT_EQ(1, manifest.entries.count("content.xml"));
+  ASSERT_EQ(1, manifest.entries.count("styles.xml"));
+  EXPECT_EQ(original->open("styles.xml")->size(),
+            manifest.entries.at("styles.xml").size);
+  for (auto &&[path, entry] : manifest.entries) {
+    EXPECT_EQ(odf::ChecksumType::SHA256_1K, entry.checksum_type) << path;
+    EXPECT_EQ(32, entry.checksum.size()) << path;
+    EXPECT_EQ(odf::AlgorithmType::AES256_CBC, entry.algorithm) << path;
+    EXPECT_EQ(16, entry.initialisation_vector.size()) << path;
+    EXPECT_EQ(odf::KeyDerivationType::PBKDF2, entry.key_derivation) << path;
+    EXPECT_EQ(32, entry.key_size) << path;
+    EXPECT_EQ(100000, entry.key_iteration_count) << path;
+    EXPECT_EQ(16, entry.key_salt.size()) << path;
+    EXPECT_EQ(odf::ChecksumType::SHA256, entry.start_key_generation) << path;
+    EXPECT_EQ(32, entry.start_key_size) << path;
+  }
+}
@@ -1,6 +1,8 @@
 #include <cstring>
 #include <gtest/gtest.h>
 #include <internal/ooxml/ooxml_crypto.h>
+#include <memory>
+#include <odr/exceptions.h>
 #include <string>
 
 using namespace odr::internal::ooxml;
@@ -45,3 +47,110 @@ TEST(OoxmlCrypto, ECMA376Standard_verify) {
                                  encrypted_verifier_hash);
   EXPECT_TRUE(crypto.verify(key));
 }
+
+namespace {
+// generated with hashlib and the openssl command line tool; password
+// "Password1234_", SHA512, AES-256 and a spin count of 1000
+const std::string agile_encryption_info =
+    std::string("\x04\x00\x04\x00\x40\x00\x00\x00", 8) +
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?><encr"
+    "yption xmlns=\"http://schemas.microsoft.com/office/2006/encryption"
+    "\" xmlns:p=\"http://schemas.microsoft.com/office/2006/keyEncryptor"
+    "/password\"><keyData saltSize=\"16\" blockSize=\"16\" keyBits=\"25"
+    "6\" hashSize=\"64\" cipherAlgorithm=\"AES\" cipherChaining=\"Chain"
+    "ingModeCBC\" hashAlgorithm=\"SHA512\" saltValue=\"MDEyMzQ1Njc4OTo7"
+    "PD0+Pw==\"/><keyEncryptors><keyEncryptor uri=\"http://schemas.micr"
+    "osoft.com/office/2006/keyEncryptor/password\"><p:encryptedKey spin"
+    "Count=\"1000\" saltSize=\"16\" blockSize=\"16\" keyBits=\"256\" ha"
+    "shSize=\"64\" cipherAlgorithm=\"AES\" cipherChaining=\"ChainingMod"
+    "eCBC\" hashAlgorithm=\"SHA512\" saltValue=\"EBESExQVFhcYGRobHB0eHw"
+    "==\" encryptedVerifierHashInput=\"uUoAqRrm22wtqeWw8NohwQ==\" encry"
+    "ptedVerifierHashValue=\"Nb1RYmb52JqTEwhEKkzpfg8iKFlk91B40AiicKgYk9"
+    "44xr4SfBWmT3gWyjdox3vS+pIp3amOBjMbua37Et7DCQ==\" encryptedKeyValue"
+    "=\"QBL9sc8Fbm3hERUBRewiWv1sZNgAm78d64KA5pmSwOQ=\"/></keyEncryptor>"
+    "</keyEncryptors></encryption>";
+const std::string agile_key(
+    "\x7f\x6a\x6f\xc7\x1f\xea\x13\x22\x99\x19\x1d\xa1\xfa\x9c\xd3\xda"
+    "\x14\x40\xf7\x4a\xed\xfc\x89\x5d\xcf\xae\xcc\x98\x0e\xb5\xf2\xf9"
+    "\x55\x9f\x33\x19\x93\x32\xf1\x9c\xa0\x40\x69\x01\x28\x82\x2f\x2f"
+    "\x5d\xb1\xea\x34\xef\x04\x77\xdf\x91\x64\x8f\x80\x29\xbf\x0e\xfc",
+    64);
+const std::string agile_package_key(
+    "\x70\x71\x72\x73\x74\x75\x76\x77\x78\x79\x7a\x7b\x7c\x7d\x7e\x7f"
+    "\x80\x81\x82\x83\x84\x85\x86\x87\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f",
+    32);
+} // namespace
+
+TEST(OoxmlCrypto, ECMA376Agile_derive_key) {
+  const Crypto::ECMA376Agile crypto(agile_encryption_info);
+  EXPECT_EQ(agile_key, crypto.derive_key("Password1234_"));
+}
+
+TEST(OoxmlCrypto, ECMA376Agile_verify) {
+  const Crypto::ECMA376Agile crypto(agile_encryption_info);
+  EXPECT_TRUE(crypto.verify(agile_key));
+  EXPECT_FALSE(crypto.verify(crypto.derive_key("password")));
+}
+
+TEST(OoxmlCrypto, ECMA376Agile_package_key) {
+  const Crypto::ECMA376Agile crypto(agile_encryption_info);
+  EXPECT_EQ(agile_package_key, crypto.package_key(agile_key));
+}
+
+TEST(OoxmlCrypto, ECMA376Agile_decrypt_segment) {
+  const Crypto::ECMA376Agile crypto(agile_encryption_info);
+  const std::string segments[]{
+      std::string(
+          "\x46\x07\xbc\xe9\x9a\x78\x35\x91\xbc\xcb\x26\x80\x34\x56\xa7\x08"
+          "\x87\x54\xe1\xc3\xe6\xcc\x88\xd4\x8e\xc8\x68\xd5\x52\x46\x88\x19",
+          32),
+      std::string(
+          "\xe6\xb0\x3b\xd6\xbf\x32\xcb\xb0\xc3\x2d\xf1\xf4\x93\x20\xbb\xf2"
+          "\x8b\xe7\x0f\x7f\xf1\x6c\xd0\x20\xbd\x7b\x5b\x58\xf9\x0b\xaa\xa6",
+          32),
+  };
+
+  char output[32];
+  crypto.decrypt_segment(agile_package_key, 0, segments[0].data(), output,
+                         sizeof(output));
+  EXPECT_EQ("segment one of the package .....",
+            std::string(output, sizeof(output)));
+  crypto.decrypt_segment(agile_package_key, 1, segments[1].data(), output,
+                         sizeof(output));
+  EXPECT_EQ("segment two of the package .....",
+            std::string(output, sizeof(output)));
+}
+
+TEST(OoxmlCrypto, ECMA376Agile_spin_count) {
+  std::string encryption_info = agile_encryption_info;
+  const auto spin_count = encryption_info.find("spinCount=\"1000\"");
+  encryption_info.replace(spin_count, 16, "spinCount=\"100000000\"");
+  EXPECT_THROW(Crypto::ECMA376Agile{encryption_info},
+               odr::MsUnsupportedCryptoAlgorithm);
+}
+
+TEST(OoxmlCrypto, ECMA376Agile_short_key_value) {
+  std::string encryption_info = agile_encryption_info;
+  const auto begin = encryption_info.find("encryptedKeyValue=\"") + 19;
+  const auto end = encryption_info.find('"', begin);
+  encryption_info.replace(begin, end - begin, "AAAA");
+  EXPECT_THROW(Crypto::ECMA376Agile{encryption_info},
+               odr::MsUnsupportedCryptoAlgorithm);
+}
+
+TEST(OoxmlCrypto, DecryptedPackage_size_beyond_package) {
+  const auto crypto = std::make_shared<Crypto::ECMA376Standard>(
+      Crypto::EncryptionHeader{}, Crypto::EncryptionVerifier{}, "");
+  // the header claims more bytes than the 16 encrypted ones
+  const Crypto::PackageReader reader =
+      [](const std::uint64_t offset, char *buffer, const std::size_t length) {
+        const std::uint64_t size = 17;
+        std::memset(buffer, 0, length);
+        if (offset == 0) {
+          std::memcpy(buffer, &size, sizeof(size));
+        }
+      };
+
+  EXPECT_THROW(Crypto::DecryptedPackage(crypto, "", reader, 8 + 16),
+               odr::FileReadError);
+}
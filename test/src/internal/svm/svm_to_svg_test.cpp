@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <internal/svm/svm_format.h>
+#include <internal/svm/svm_to_svg.h>
+#include <odr/exceptions.h>
+#include <string>
+
+using namespace odr;
+using namespace odr::internal::svm;
+
+namespace {
+// little endian metafile of version 1 with a 100 by 100 canvas
+class SvmBuilder final {
+public:
+  SvmBuilder() {
+    m_data = "VCLMTF";
+    put<std::uint16_t>(1);
+    put<std::uint32_t>(49);
+    // compression mode
+    put<std::uint32_t>(0);
+    // map mode
+    put<std::uint16_t>(1);
+    put<std::uint32_t>(27);
+    put<std::uint16_t>(0);
+    for (int i = 0; i < 6; ++i) {
+      put<std::int32_t>(i < 2 ? 0 : 1);
+    }
+    put<bool>(true);
+    // size
+    put<std::int32_t>(100);
+    put<std::int32_t>(100);
+    // action count; not checked
+    put<std::uint32_t>(0);
+  }
+
+  SvmBuilder &color(const std::uint16_t type, const std::uint32_t rgb) {
+    action(type, 5);
+    put<std::uint32_t>(rgb);
+    put<bool>(true);
+    return *this;
+  }
+
+  SvmBuilder &rectangle(const std::int32_t left, const std::int32_t top,
+                        const std::int32_t right, const std::int32_t bottom) {
+    action(META_RECT_ACTION, 16);
+    put<std::int32_t>(left);
+    put<std::int32_t>(top);
+    put<std::int32_t>(right);
+    put<std::int32_t>(bottom);
+    return *this;
+  }
+
+  SvmBuilder &line(const std::int32_t x0, const std::int32_t y0,
+                   const std::int32_t x1, const std::int32_t y1) {
+    action(META_POLYLINE_ACTION, 18);
+    put<std::uint16_t>(2);
+    put<std::int32_t>(x0);
+    put<std::int32_t>(y0);
+    put<std::int32_t>(x1);
+    put<std::int32_t>(y1);
+    return *this;
+  }
+
+  // an action header claiming more bytes than follow
+  SvmBuilder &truncated() {
+    action(META_RECT_ACTION, 16);
+    put<std::int32_t>(0);
+    return *this;
+  }
+
+  [[nodiscard]] const std::string &str() const { return m_data; }
+
+private:
+  std::string m_data;
+
+  template <typename T> void put(const T value) {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      m_data += static_cast<char>((std::uint64_t(value) >> (8 * i)) & 0xff);
+    }
+  }
+
+  void action(const std::uint16_t type, const std::uint32_t length) {
+    put<std::uint16_t>(type);
+    put<std::uint16_t>(1);
+    put<std::uint32_t>(length);
+  }
+};
+
+constexpr const char *svg_begin = "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                                  "version=\"1.1\" viewBox=\"0 0 100 100\">";
+constexpr const char *fill_style =
+    ".s0{stroke-opacity:0;vector-effect:non-scaling-stroke;fill:none;"
+    "fill:rgb(255,0,0);stroke:none;}";
+} // namespace
+
+TEST(SvmToSvg, merge_disjoint_fills) {
+  const SvmBuilder svm = SvmBuilder()
+                             .color(META_FILLCOLOR_ACTION, 0xff0000)
+                             .rectangle(0, 0, 10, 10)
+                             .rectangle(20, 0, 30, 10);
+
+  EXPECT_EQ(std::string(svg_begin) + "<style>" + fill_style + "</style>" +
+                "<path class=\"s0\" d=\"M 0 0h 10v 10h-10zM 20 0h 10v "
+                "10h-10z\"/></svg>",
+            *Translator::svg(svm.str()));
+}
+
+TEST(SvmToSvg, split_overlapping_fills) {
+  const SvmBuilder svm = SvmBuilder()
+                             .color(META_FILLCOLOR_ACTION, 0xff0000)
+                             .rectangle(0, 0, 10, 10)
+                             .rectangle(5, 5, 15, 15);
+
+  EXPECT_EQ(std::string(svg_begin) + "<style>" + fill_style + "</style>" +
+                "<path class=\"s0\" d=\"M 0 0h 10v 10h-10z\"/>"
+                "<path class=\"s0\" d=\"M 5 5h 10v 10h-10z\"/></svg>",
+            *Translator::svg(svm.str()));
+}
+
+TEST(SvmToSvg, merge_strokes) {
+  const SvmBuilder svm = SvmBuilder()
+                             .color(META_LINECOLOR_ACTION, 0x0000ff)
+                             .line(0, 0, 10, 10)
+                             .line(0, 10, 10, 0);
+
+  EXPECT_EQ(std::string(svg_begin) +
+                "<style>.s0{stroke:rgb(0,0,255);"
+                "vector-effect:non-scaling-stroke;fill:none;}</style>"
+                "<path class=\"s0\" d=\"M 0 0l 10 10M 0 10l 10-10\"/></svg>",
+            *Translator::svg(svm.str()));
+}
+
+TEST(SvmToSvg, truncated_action) {
+  const SvmBuilder svm = SvmBuilder().rectangle(0, 0, 10, 10).truncated();
+
+  EXPECT_THROW(Translator::svg(svm.str()), MalformedSvmFile);
+}
+
+TEST(SvmToSvg, truncated_header) {
+  const std::string svm = SvmBuilder().str().substr(0, 20);
+
+  EXPECT_THROW(Translator::svg(svm), MalformedSvmFile);
+}
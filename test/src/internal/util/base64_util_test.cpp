@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <internal/util/base64_util.h>
+#include <string>
+
+using namespace odr::internal::util;
+
+TEST(base64, encode) {
+  EXPECT_EQ("", base64::encode(""));
+  EXPECT_EQ("Zg==", base64::encode("f"));
+  EXPECT_EQ("Zm8=", base64::encode("fo"));
+  EXPECT_EQ("Zm9v", base64::encode("foo"));
+  EXPECT_EQ("Zm9vYg==", base64::encode("foob"));
+  EXPECT_EQ("Zm9vYmFy", base64::encode("foobar"));
+}
+
+TEST(base64, encode_long) {
+  std::string data;
+  for (int i = 0; i < 256; ++i) {
+    data += static_cast<char>(i);
+  }
+  const std::string encoded = base64::encode(data);
+
+  EXPECT_EQ(base64::encoded_length(data.size()), encoded.size());
+  EXPECT_EQ("AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8g",
+            encoded.substr(0, 44));
+  EXPECT_EQ("8PHy8/T19vf4+fr7/P3+/w==", encoded.substr(encoded.size() - 24));
+}
+
+TEST(base64, encode_split) {
+  const std::string data = "the quick brown fox jumps over the lazy dog";
+  std::string encoded(base64::encoded_length(data.size()), '\0');
+  char *out = encoded.data();
+  out = base64::encode(data.data(), data.data() + 21, out);
+  out = base64::encode(data.data() + 21, data.data() + data.size(), out);
+
+  EXPECT_EQ(encoded.data() + encoded.size(), out);
+  EXPECT_EQ(base64::encode(data), encoded);
+}
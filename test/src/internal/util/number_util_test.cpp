@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <internal/util/number_util.h>
+
+using namespace odr::internal::util;
+
+TEST(number, to_string) {
+  EXPECT_EQ("0", number::to_string(0.0, 6));
+  EXPECT_EQ("0", number::to_string(-0.0000001, 6));
+  EXPECT_EQ("1.5", number::to_string(1.5, 6));
+  EXPECT_EQ("-0.25", number::to_string(-0.25, 6));
+  EXPECT_EQ("1.234568", number::to_string(1.2345678, 6));
+  EXPECT_EQ("1000", number::to_string(999.9999999, 6));
+  EXPECT_EQ("12345678.9", number::to_string(12345678.9, 6));
+}
+
+TEST(number, to_string_untrimmed) {
+  EXPECT_EQ("1.50", number::to_string(1.5, 2, false));
+  EXPECT_EQ("2", number::to_string(1.5, 0, false));
+}
+
+TEST(number, units) {
+  EXPECT_EQ("1", number::to_string(number::emu_to_inch(914400), 6));
+  EXPECT_EQ("0.5", number::to_string(number::twip_to_inch(720), 6));
+}
+
+TEST(number, to_string_out_of_range) {
+  EXPECT_EQ("1e+20", number::to_string(1e20, 6));
+  EXPECT_EQ("-1e+20", number::to_string(-1e20, 6));
+  EXPECT_EQ("1.5e+300", number::to_string(1.5e300, 6));
+  EXPECT_EQ("1e+10", number::to_string(9999999999.9999999, 9));
+  EXPECT_EQ("1.25e+18", number::to_string(1.25e18, 0));
+  EXPECT_EQ("inf", number::to_string(1.0 / 0.0, 6));
+  EXPECT_EQ("-inf", number::to_string(-1.0 / 0.0, 6));
+}
@@ -0,0 +1,33 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <internal/util/thread_util.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace odr::internal::util;
+
+TEST(thread, parallel_for) {
+  std::vector<std::atomic<int>> calls(1000);
+  thread::parallel_for(calls.size(), 4,
+                       [&](const std::size_t i) { ++calls[i]; });
+  for (auto &&c : calls) {
+    EXPECT_EQ(1, c);
+  }
+}
+
+TEST(thread, parallel_for_serial) {
+  std::vector<std::size_t> order;
+  thread::parallel_for(3, 1,
+                       [&](const std::size_t i) { order.push_back(i); });
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 2}), order);
+}
+
+TEST(thread, parallel_for_exception) {
+  EXPECT_THROW(thread::parallel_for(100, 4,
+                                    [](const std::size_t i) {
+                                      if (i == 42) {
+                                        throw std::runtime_error("42");
+                                      }
+                                    }),
+               std::runtime_error);
+}